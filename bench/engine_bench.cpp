@@ -0,0 +1,140 @@
+#include "engine/World.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * Builds a script with characters fighting and showing their state
+ * @param commandCount Number of commands
+ * @return Lines of the script
+ */
+vector<string> makeScript(int commandCount)
+{
+    vector<string> commands;
+    int characterCount = max(1, commandCount / 10);
+    for (int i = 0; i < characterCount && static_cast<int>(commands.size()) < commandCount; i++) {
+        commands.push_back("Create character fighter F" + to_string(i) + " 1000");
+        commands.push_back("Create item weapon F" + to_string(i) + " Sword" + to_string(i) + " 1");
+    }
+    for (int i = 0; static_cast<int>(commands.size()) < commandCount; i++) {
+        string attacker = "F" + to_string(i % characterCount);
+        string target = "F" + to_string((i + 1) % characterCount);
+        if (i % 4 == 3) {
+            commands.push_back("Show weapons " + attacker);
+        } else {
+            commands.push_back("Attack " + attacker + " " + target + " Sword" + to_string(i % characterCount));
+        }
+    }
+    return commands;
+}
+
+/**
+ * Runs the script through the executable in a scratch directory
+ * @param executable Path to the executable
+ * @param directory Scratch directory
+ * @param commands Lines of the script
+ * @return Content of output.txt, empty if the executable could not be run
+ */
+string runProcess(const string &executable, const string &directory, const vector<string> &commands)
+{
+    {
+        ofstream input(directory + "/input.txt");
+        input << commands.size() << '\n';
+        for (const auto &command: commands) {
+            input << command << '\n';
+        }
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(directory.c_str()) == 0) {
+            execl(executable.c_str(), executable.c_str(), static_cast<char *>(nullptr));
+        }
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return "";
+    }
+    ifstream output(directory + "/output.txt");
+    return string(istreambuf_iterator<char>(output), istreambuf_iterator<char>());
+}
+
+/**
+ * Runs the script through a fresh World in this process
+ * @param commands Lines of the script
+ * @param batch Whether to pass all commands in one executeBatch call
+ * @return Output of the script
+ */
+string runInProcess(const vector<string> &commands, bool batch)
+{
+    World world;
+    string out;
+    if (batch) {
+        vector<string_view> lines(commands.begin(), commands.end());
+        world.executeBatch(lines, out);
+    } else {
+        for (const auto &command: commands) {
+            world.execute(command, out);
+        }
+    }
+    return out;
+}
+
+/**
+ * Times a function over a number of runs
+ * @return Mean time of a run in microseconds
+ */
+template<typename F>
+double timeRuns(int runs, F &&function)
+{
+    auto start = chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        function();
+    }
+    chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / runs;
+}
+
+/**
+ * Compares running scripts through the engine library in process with running them
+ * the old way: writing input.txt, spawning the executable and reading output.txt back.
+ * Usage: engine_bench [path to the executable] [runs] [commands per run]
+ */
+int main(int argc, char *argv[])
+{
+    string executable = argc > 1 ? argv[1] : SSAD_EXECUTABLE;
+    int runs = argc > 2 ? max(1, atoi(argv[2])) : 50;
+    int commandCount = argc > 3 ? max(1, atoi(argv[3])) : 100;
+    vector<string> commands = makeScript(commandCount);
+
+    char pattern[] = "/tmp/engine_bench.XXXXXX";
+    if (!mkdtemp(pattern)) {
+        cerr << "Can not create a scratch directory" << endl;
+        return 1;
+    }
+    string directory = pattern;
+
+    string expected = runInProcess(commands, true);
+    if (runInProcess(commands, false) != expected || runProcess(executable, directory, commands) != expected) {
+        cerr << "Outputs of the engine and of " << executable << " differ" << endl;
+        return 1;
+    }
+
+    double batch = timeRuns(runs, [&] { runInProcess(commands, true); });
+    double single = timeRuns(runs, [&] { runInProcess(commands, false); });
+    double process = timeRuns(runs, [&] { runProcess(executable, directory, commands); });
+
+    unlink((directory + "/input.txt").c_str());
+    unlink((directory + "/output.txt").c_str());
+    rmdir(directory.c_str());
+
+    cout << runs << " runs of " << commands.size() << " commands, mean time of a run:\n";
+    cout << "  in process, executeBatch: " << batch << " us\n";
+    cout << "  in process, execute:      " << single << " us\n";
+    cout << "  spawned executable:       " << process << " us (" << process / batch << "x executeBatch)\n";
+    return 0;
+}
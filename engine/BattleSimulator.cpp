@@ -0,0 +1,155 @@
+#include "BattleSimulator.h"
+
+using namespace std;
+
+void BattleSimulator::run(int trials, int steps, uint64_t seed, OutputBuffer &out)
+{
+    size_t count = max<size_t>(1, combatants.size());
+    int batchTrials = static_cast<int>(max<size_t>(1, min<size_t>(trials, maxBatchValues / count)));
+    unsigned workerCount = max(1u, min<unsigned>(thread::hardware_concurrency(), batchTrials));
+    vector<int> finalHP(static_cast<size_t>(batchTrials) * count);
+    vector<map<int, int>> histograms(combatants.size());
+    vector<int> survived(combatants.size());
+    vector<long long> total(combatants.size());
+    for (int first = 0; first < trials; first += batchTrials) {
+        int batch = min(batchTrials, trials - first);
+        if (workerCount == 1) {
+            for (int trial = 0; trial < batch; trial++) {
+                runTrial(first + trial, steps, seed, &finalHP[trial * count]);
+            }
+        } else {
+            vector<thread> workers;
+            for (unsigned w = 0; w < workerCount; w++) {
+                workers.emplace_back([&, w] {
+                    for (int trial = static_cast<int>(w); trial < batch; trial += static_cast<int>(workerCount)) {
+                        runTrial(first + trial, steps, seed, &finalHP[trial * count]);
+                    }
+                });
+            }
+            for (auto &worker: workers) {
+                worker.join();
+            }
+        }
+        //Fold the batch into the statistics in trial order, so the result does not depend on the threads
+        for (int trial = 0; trial < batch; trial++) {
+            for (size_t i = 0; i < combatants.size(); i++) {
+                int HP = finalHP[trial * count + i];
+                survived[i] += HP != dead;
+                HP = HP == dead ? 0 : max(HP, 0);
+                total[i] += HP;
+                histograms[i][HP]++;
+            }
+        }
+    }
+    out << "Simulation of " << trials << " trials with " << steps << " random actions:\n";
+    for (size_t i = 0; i < combatants.size(); i++) {
+        out << combatants[i].name << ": survival ";
+        writeFixed(out, static_cast<double>(survived[i]) / trials, 4);
+        out << ", mean HP ";
+        writeFixed(out, static_cast<double>(total[i]) / trials, 2);
+        out << ", HP p10 " << percentile(histograms[i], trials / 10) << " p50 "
+            << percentile(histograms[i], trials / 2) << " p90 "
+            << percentile(histograms[i], static_cast<long long>(trials) * 9 / 10) << '\n';
+    }
+}
+
+int BattleSimulator::percentile(const map<int, int> &histogram, long long rank)
+{
+    for (const auto &bin: histogram) {
+        if (rank < bin.second) {
+            return bin.first;
+        }
+        rank -= bin.second;
+    }
+    return histogram.empty() ? 0 : histogram.rbegin()->first;
+}
+
+void BattleSimulator::writeFixed(OutputBuffer &out, double value, int precision)
+{
+    char digits[32];
+    auto result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, precision);
+    out << string_view(digits, result.ptr - digits);
+}
+
+void BattleSimulator::runTrial(int trial, int steps, uint64_t seed, int *finalHP) const
+{
+    CounterRng rng(seed, static_cast<uint64_t>(trial));
+    size_t count = combatants.size();
+    vector<int> HP(count);
+    vector<vector<char>> potionsLeft(count);
+    vector<vector<char>> spellsLeft(count);
+    vector<int> alive(count);
+    vector<int> positionInAlive(count);
+    for (size_t i = 0; i < count; i++) {
+        HP[i] = combatants[i].HP;
+        potionsLeft[i].assign(combatants[i].potions.size(), 1);
+        spellsLeft[i].assign(combatants[i].spells.size(), 1);
+        alive[i] = static_cast<int>(i);
+        positionInAlive[i] = static_cast<int>(i);
+    }
+    size_t aliveCount = count;
+    auto kill = [&](int victim) {
+        int position = positionInAlive[victim];
+        int last = alive[--aliveCount];
+        alive[position] = last;
+        positionInAlive[last] = position;
+        positionInAlive[victim] = -1;
+    };
+    vector<int> options;
+    for (int step = 0; step < steps && aliveCount > 0; step++) {
+        int actor = alive[rng.below(static_cast<uint32_t>(aliveCount))];
+        const Combatant &combatant = combatants[actor];
+        options.clear();
+        for (size_t j = 0; j < potionsLeft[actor].size(); j++) {
+            if (potionsLeft[actor][j]) {
+                options.push_back(static_cast<int>(j));
+            }
+        }
+        bool canAttack = !combatant.weapons.empty();
+        bool canDrink = !options.empty();
+        bool canCast = find(spellsLeft[actor].begin(), spellsLeft[actor].end(), 1) != spellsLeft[actor].end();
+        uint32_t kinds = canAttack + canDrink + canCast;
+        if (kinds == 0) {
+            continue;
+        }
+        uint32_t kind = rng.below(kinds);
+        if (canAttack && kind-- == 0) {
+            int damage = combatant.weapons[rng.below(static_cast<uint32_t>(combatant.weapons.size()))];
+            int target = alive[rng.below(static_cast<uint32_t>(aliveCount))];
+            HP[target] -= damage;
+            if (HP[target] <= 0) {
+                kill(target);
+            }
+        } else if (canDrink && kind-- == 0) {
+            int potion = options[rng.below(static_cast<uint32_t>(options.size()))];
+            int drinker = alive[rng.below(static_cast<uint32_t>(aliveCount))];
+            HP[drinker] += combatant.potions[potion];
+            potionsLeft[actor][potion] = 0;
+        } else {
+            options.clear();
+            for (size_t j = 0; j < spellsLeft[actor].size(); j++) {
+                if (spellsLeft[actor][j]) {
+                    options.push_back(static_cast<int>(j));
+                }
+            }
+            int spell = options[rng.below(static_cast<uint32_t>(options.size()))];
+            const auto &targets = combatant.spells[spell];
+            options.clear();
+            for (int target: targets) {
+                if (positionInAlive[target] >= 0) {
+                    options.push_back(target);
+                }
+            }
+            if (options.empty()) {
+                continue;
+            }
+            int target = options[rng.below(static_cast<uint32_t>(options.size()))];
+            spellsLeft[actor][spell] = 0;
+            HP[target] = 0;
+            kill(target);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        finalHP[i] = positionInAlive[i] >= 0 ? HP[i] : dead;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Output.h"
+
+/**
+ * Monte Carlo estimate of how a battle may end. Starting from a copy of the world,
+ * every trial performs a number of random Attack, Drink and Cast actions, and the
+ * final HP of every character is collected over all trials.
+ * Trials run in parallel on all hardware threads. Every random number is a pure
+ * function of (seed, trial, draw number), so results are bit-for-bit the same for
+ * any number of threads
+ * @param combatants - state of the characters at the start of every trial
+ * @param maxBatchValues - final HP values kept at once; trials run in batches of this size
+ * and are folded into per-character histograms, so memory does not grow with trials
+ */
+class BattleSimulator
+{
+public:
+    /**
+     * Character as the simulation sees it
+     * @param weapons - damage of every weapon
+     * @param potions - heal value of every potion
+     * @param spells - indices of the allowed targets of every spell
+     */
+    struct Combatant
+    {
+        std::string name;
+        int HP;
+        std::vector<int> weapons;
+        std::vector<int> potions;
+        std::vector<std::vector<int>> spells;
+    };
+
+private:
+    std::vector<Combatant> combatants;
+    static constexpr int dead = INT_MIN;
+    static constexpr size_t maxBatchValues = 1 << 22;
+
+    /**
+     * Counter-based random generator: the n-th number of a stream is a hash of
+     * the stream key and n, no state is carried over from one number to the next
+     */
+    class CounterRng
+    {
+    private:
+        uint64_t key;
+        uint64_t counter = 0;
+    public:
+        CounterRng(uint64_t seed, uint64_t stream) : key(mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ULL))) {}
+
+        /**
+         * @return Random number in [0, bound)
+         */
+        uint32_t below(uint32_t bound)
+        {
+            uint64_t value = mix(key + ++counter * 0x9E3779B97F4A7C15ULL);
+            return static_cast<uint32_t>(((value >> 32) * bound) >> 32);
+        }
+
+        static uint64_t mix(uint64_t value)
+        {
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            return value ^ (value >> 31);
+        }
+    };
+
+public:
+    explicit BattleSimulator(std::vector<Combatant> combatants) : combatants(std::move(combatants)) {}
+
+    ~BattleSimulator() = default;
+
+    /**
+     * Runs the trials and prints survival probability and HP distribution of every character
+     * @param trials Number of trials
+     * @param steps Number of random actions in every trial
+     * @param seed Seed of the random numbers
+     * @param out Buffer to print the report to
+     */
+    void run(int trials, int steps, uint64_t seed, OutputBuffer &out);
+
+private:
+    static void writeFixed(OutputBuffer &out, double value, int precision);
+
+    /**
+     * @param histogram Number of trials that ended with every HP value
+     * @param rank Position in the sorted list of all final HP values
+     * @return HP value at the position
+     */
+    static int percentile(const std::map<int, int> &histogram, long long rank);
+
+    /**
+     * Plays one trial
+     * @param trial Number of the trial, selects its stream of random numbers
+     * @param steps Number of random actions
+     * @param seed Seed of the random numbers
+     * @param finalHP Where to write the HP of every character at the end, dead if it died
+     */
+    void runTrial(int trial, int steps, uint64_t seed, int *finalHP) const;
+};
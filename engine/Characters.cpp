@@ -0,0 +1,22 @@
+#include "Characters.h"
+#include "RosterIndex.h"
+
+using namespace std;
+
+void Character::takeDamage(int damage)
+{
+    int oldHP = healthPoints;
+    healthPoints -= damage;
+    if (rosterIndex) {
+        rosterIndex->updateHP(*this, oldHP);
+    }
+}
+
+void Character::heal(int healValue)
+{
+    int oldHP = healthPoints;
+    healthPoints += healValue;
+    if (rosterIndex) {
+        rosterIndex->updateHP(*this, oldHP);
+    }
+}
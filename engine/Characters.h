@@ -0,0 +1,883 @@
+#pragma once
+
+#include "Events.h"
+#include "Tracing.h"
+
+class PhysicalItem;
+class RosterIndex;
+class StatusEffects;
+class World;
+
+/**
+ * Abstract class for creating characters
+ * @param healthPoint - Health
+ * @param name - Character name
+ * @param rosterIndex - index that is notified about HP changes, if any
+ * @param id - ID of the character in the event stream
+ */
+class Character
+{
+    friend PhysicalItem;
+    friend RosterIndex;
+    friend StatusEffects;
+    friend World;
+protected:
+    int healthPoints;
+    const std::string name;
+    RosterIndex *rosterIndex = nullptr;
+    int id = 0;
+
+    virtual void writeTo(OutputBuffer &out) const
+    {
+        out << name;
+    }
+
+public:
+    Character(std::string &n, int HP) : name(n), healthPoints(HP) {}
+
+    virtual ~Character() = default;
+
+    /**
+     * Method for making characters speak
+     * @param words Words for a character to say
+     * @return The speech as written to the output
+     */
+    std::string_view speak(std::span<const std::string_view> words)
+    {
+        auto &out = output();
+        out << name << ": ";
+        size_t start = out.str().size();
+        for (const auto &word: words) {
+            out << word << ' ';
+        }
+        size_t end = out.str().size();
+        out << '\n';
+        return std::string_view(out.str()).substr(start, end - start);
+    }
+
+    //Getter
+    const std::string &getName() const
+    {
+        return name;
+    }
+
+    //Getter
+    virtual int getHP() const
+    {
+        return healthPoints;
+    }
+
+    //Getter
+    virtual std::string getRole() const
+    {
+        return "";
+    }
+
+    //Getter
+    int getId() const
+    {
+        return id;
+    }
+
+    //Setter
+    void setId(int newId)
+    {
+        id = newId;
+    }
+
+    /**
+     * Method for getting item into the inventory
+     * @param item The item to obtain
+     */
+    virtual void obtainItem(const std::shared_ptr<const PhysicalItem> &item)
+    {
+
+    }
+
+    /**
+     * << operator overrule
+     */
+    friend OutputBuffer &operator<<(OutputBuffer &out, const Character &character)
+    {
+        character.writeTo(out);
+        return out;
+    }
+
+private:
+    /**
+     * Method for taking damage
+     * @param damage Amount of damage to take
+     */
+    virtual void takeDamage(int damage);
+
+    /**
+     * Method for healing
+     * @param healValue Amount of healing to receive
+     */
+    virtual void heal(int healValue);
+};
+
+/**
+ * Base abstract class for physical items.
+ * Items are immutable once created, so one item can be held by many characters at once
+ * @param name - Name of the item
+ * @param id - ID of the item in the event stream
+ */
+class PhysicalItem
+{
+protected:
+    std::string name;
+    int id = 0;
+
+public:
+    PhysicalItem(const std::string &n) : name(n) {}
+
+    virtual ~PhysicalItem() = default;
+
+    friend OutputBuffer &operator<<(OutputBuffer &out, const PhysicalItem &physicalItem)
+    {
+        physicalItem.writeTo(out);
+        out << ' ';
+        return out;
+    }
+
+    const std::string &getName() const
+    {
+        return name;
+    }
+
+    //Getter
+    int getId() const
+    {
+        return id;
+    }
+
+    //Setter
+    void setId(int newId)
+    {
+        id = newId;
+    }
+
+    /**
+     * Method for using the logic of the item
+     * @param target Character that will get item effects
+     */
+    virtual void useLogic(Character &target) const
+    {
+
+    }
+
+protected:
+    /**
+     * Method for giving damage to another player
+     * @param to Target character
+     * @param damage Amount of damage to give
+     */
+    void giveDamageTo(Character &to, int damage) const
+    {
+        to.takeDamage(damage);
+    }
+
+    /**
+     * Method to heal player
+     * @param to Target character
+     * @param heal Amount of healing to give
+     */
+    void giveHealTo(Character &to, int heal) const
+    {
+        to.heal(heal);
+    }
+
+    virtual void writeTo(OutputBuffer &out) const
+    {
+        out << name;
+    }
+
+};
+
+/**
+ * Child class of a physical item
+ * @param damage - amount of damage that will be dealt with this weapon
+ * @see PhysicalItem
+ */
+class Weapon : public PhysicalItem
+{
+private:
+    int damage;
+public:
+    static constexpr int kind = 1;
+
+    Weapon(const std::string &n, int damage) : PhysicalItem(n), damage(damage) {}
+
+    ~Weapon() = default;
+
+    //Getter
+    int getDamage() const
+    {
+        return damage;
+    }
+
+    void useLogic(Character &target) const override
+    {
+        giveDamageTo(target, damage);
+    }
+
+protected:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ':' << damage;
+    }
+
+};
+
+/**
+ * Child class of a physical item
+ * @param healValue - amount of HP given to a character
+ * @see PhysicalItem
+ */
+class Potion : public PhysicalItem
+{
+private:
+    int healValue;
+public:
+    static constexpr int kind = 2;
+
+    Potion(const std::string &n, int healValue) : PhysicalItem(n), healValue(healValue) {}
+
+    ~Potion() = default;
+
+    //Getter
+    int getHealValue() const
+    {
+        return healValue;
+    }
+
+    void useLogic(Character &target) const override
+    {
+        giveHealTo(target, healValue);
+    }
+
+protected:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ':' << healValue;
+    }
+};
+
+/**
+ * Child class of a physical item
+ * @param allowedTargets - map of characters that can be attacked with a spell
+ * @see PhysicalItem
+ */
+class Spell : public PhysicalItem
+{
+private:
+    std::map<std::string, std::shared_ptr<Character>> allowedTargets;
+public:
+    static constexpr int kind = 3;
+
+    Spell(const std::string &n, std::map<std::string, std::shared_ptr<Character>> &targets)
+            : PhysicalItem(n), allowedTargets(targets) {}
+
+    ~Spell() = default;
+
+    void useLogic(Character &target) const override
+    {
+        auto it = allowedTargets.find(target.getName());
+        if (it != allowedTargets.end() && it->second) {
+            giveDamageTo(target, target.getHP());
+        } else {
+            errorCaught(ErrorReason::TargetNotAllowed);
+        }
+    }
+
+    /**
+     * Checks if target character is in allowedTargets list
+     * @param target A character to check
+     * @see allowedTargets
+     */
+    bool isTargetInList(Character &target) const
+    {
+        auto it = allowedTargets.find(target.getName());
+        return it != allowedTargets.end() && it->second;
+    }
+
+    //Getter
+    const std::map<std::string, std::shared_ptr<Character>> &getTargets() const
+    {
+        return allowedTargets;
+    }
+
+    //Getter
+    int getTargetCount() const
+    {
+        return static_cast<int>(allowedTargets.size());
+    }
+
+protected:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ':' << allowedTargets.size();
+    }
+
+};
+
+/**
+ * Interning table of weapons and potions. Every distinct (type, name, value) exists
+ * once no matter how many characters hold it, so item memory grows with the number
+ * of distinct items instead of the number of copies. Spells are not interned since
+ * every spell has its own list of targets
+ * @param items - created items; entries of items that no character holds any more
+ * expire and are erased once their number reaches sweepAt
+ * @param sweepAt - size of items at which the expired entries are erased
+ */
+class ItemRegistry
+{
+private:
+    std::map<std::tuple<int, std::string, int>, std::weak_ptr<const PhysicalItem>> items;
+    size_t sweepAt = minSweep;
+    static constexpr size_t minSweep = 1024;
+public:
+    ItemRegistry() = default;
+
+    ~ItemRegistry() = default;
+
+    /**
+     * Gets the shared item with the given name and value, creating it if needed
+     * @param name Name of the item
+     * @param value Damage of a weapon or heal value of a potion
+     * @param nextId Counter of IDs, used if a new item is created
+     * @return The shared item
+     */
+    template<typename T>
+    std::shared_ptr<const T> intern(const std::string &name, int value, int &nextId)
+    {
+        auto &slot = items[{T::kind, name, value}];
+        if (auto existing = slot.lock()) {
+            return std::static_pointer_cast<const T>(existing);
+        }
+        auto item = std::make_shared<T>(name, value);
+        item->setId(nextId++);
+        slot = item;
+        if (items.size() >= sweepAt) {
+            std::erase_if(items, [](const auto &entry) { return entry.second.expired(); });
+            sweepAt = std::max(minSweep, 2 * items.size());
+        }
+        return item;
+    }
+};
+
+/**
+ * Definition of a Container class
+ */
+template<typename T>
+class Container
+{
+protected:
+    std::vector<T> elems;
+public:
+    Container() = default;
+
+    ~Container() = default;
+};
+
+template<typename T>
+concept DerivedFromPhysicalItem = std::is_base_of<PhysicalItem, T>::value;
+
+/**
+ * Declaration of a container class with template type T, being all items derived from PhysicalItem.
+ * Every item is shared with all other holders of the same item, and a name holds one
+ * item at most: items are not stacked
+ * @param elements - map of items in the inventory by name
+ * @param maxCapacity - max number of items
+ * @see PhysicalItem
+ */
+template<DerivedFromPhysicalItem  T>
+class Container<T>
+{
+public:
+    /**
+     * Item detached from a container together with its name, see extractItem
+     */
+    using Node = typename std::map<std::string, std::shared_ptr<const T>>::node_type;
+
+private:
+    std::map<std::string, std::shared_ptr<const T>> elements;
+    int maxCapacity;
+public:
+
+    Container(int size)
+    {
+        elements = std::move(std::map<std::string, std::shared_ptr<const T>>());
+        maxCapacity = size;
+    }
+
+    ~Container()
+    {
+        elements.clear();
+    }
+
+    bool isFull()
+    {
+        return this->elements.size() == maxCapacity;
+    }
+
+    /**
+     * Adds item into the container. An item with the name of one already in the
+     * container is ignored
+     * @param newItem Item to add to the container
+     */
+    void addItem(std::shared_ptr<const T> newItem)
+    {
+        const std::string &itemName = newItem->getName();
+        auto it = elements.find(itemName);
+        if (it == elements.end()) {
+            elements.emplace_hint(it, itemName, std::move(newItem));
+        }
+    }
+
+    /**
+     * Gets a pointer to an item from the container
+     * @param item The item to get a pointer to
+     */
+    const std::shared_ptr<const T> &getItem(const std::string &item)
+    {
+        return elements.at(item);
+    }
+
+    /**
+     * Checks if item is in the container
+     * @param item Item to check
+     */
+    bool find(const std::string &item)
+    {
+        return elements.contains(item);
+    }
+
+    /**=
+     * @return Map of all items in the container
+     */
+    std::map<std::string, std::shared_ptr<const T>> &toShow()
+    {
+        return elements;
+    }
+
+    /**
+     * Takes an item out of the container without copying or freeing it
+     * @param itemName Name of the item to take
+     * @return Node of the item, to be put into another container with insertItem
+     */
+    Node extractItem(const std::string &itemName)
+    {
+        return elements.extract(itemName);
+    }
+
+    /**
+     * Puts an item taken from another container into this one. The container must
+     * not have an item with the same name
+     * @param node Node of the item
+     */
+    void insertItem(Node node)
+    {
+        elements.insert(std::move(node));
+    }
+
+    //Getter
+    int size() const
+    {
+        return static_cast<int>(elements.size());
+    }
+
+    //Getter
+    int getCapacity() const
+    {
+        return maxCapacity;
+    }
+
+    /**
+     * Removes item from the container
+     * @param itemName Name of item to remove
+     */
+    void removeItem(const std::string &itemName)
+    {
+        elements.erase(itemName);
+    }
+
+    /**
+     * Changes the size of the container
+     * @param size Size of the container
+     */
+    void resizeContainer(int size)
+    {
+        maxCapacity = size;
+    }
+
+};
+
+/**
+ * Arsenal type, for Container<Weapons>
+ */
+typedef Container<Weapon> Arsenal;
+/**
+ * MedicalBag type, for Container<Potion>
+ */
+typedef Container<Potion> MedicalBag;
+/**
+ * SpellBook type, for Container<Spell>
+ */
+typedef Container<Spell> SpellBook;
+
+/**
+ * Child class of a character
+ * Allows to store and use weapons
+ * @param arsenal - container for weapon type items
+ * @see Character
+ * @see Container
+ * @see Arsenal
+ * @see Weapon
+ */
+class WeaponUser : virtual public Character
+{
+protected:
+    Arsenal arsenal;
+public:
+    WeaponUser(std::string &n, int HP) : Character(n, HP), arsenal(0)
+    {
+
+    }
+
+    ~WeaponUser() = default;
+
+    bool isFull()
+    {
+        return arsenal.isFull();
+    }
+
+    //Getter
+    Arsenal &getArsenal()
+    {
+        return arsenal;
+    }
+
+    /**
+     * Method for showing weapons
+     * @param out Buffer to show the weapons in
+     */
+    void showWeapons(OutputBuffer &out = output())
+    {
+        for (const auto &weapon: arsenal.toShow()) {
+            out << *weapon.second << ' ';
+        }
+        out << '\n';
+    }
+
+    /**
+     * Method for attacking another player
+     * @param target Target character
+     * @param weaponName Weapon to attack with
+     */
+    void attack(Character &target, std::string weaponName)
+    {
+        TraceSpan span("attack");
+        if (arsenal.find(weaponName)) {
+            auto &weapon = arsenal.getItem(weaponName);
+            weapon->useLogic(target);
+            output() << name << " attacks " << target.getName() << " with their " << weaponName << "!\n";
+            if (EventSink::active) {
+                EventSink::active->damage(id, target.getId(), weapon->getId(), weapon->getDamage());
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownItem);
+        }
+
+    }
+};
+
+/**
+ * Child class of a character
+ * Allows to store and use potions
+ * @param medicalBag - container for potion type items
+ * @see Character
+ * @see Container
+ * @see MedicalBag
+ * @see Potion
+ */
+class PotionUser : virtual public Character
+{
+protected:
+    MedicalBag medicalBag;
+public:
+    PotionUser(std::string &n, int HP) : Character(n, HP), medicalBag(0) {}
+
+    ~PotionUser() = default;
+
+    bool isFull()
+    {
+        return medicalBag.isFull();
+    };
+
+    //Getter
+    MedicalBag &getMedicalBag()
+    {
+        return medicalBag;
+    }
+
+    /**
+     * Method for showing potions
+     * @param out Buffer to show the potions in
+     */
+    void showPotions(OutputBuffer &out = output())
+    {
+        for (const auto &potion: medicalBag.toShow()) {
+            out << *potion.second << ' ';
+        }
+        out << '\n';
+    }
+
+    /**
+     * Method for drinking potions
+     * @param target Target character
+     * @param potionName Name of the potion to drink
+     */
+    void drink(Character &target, std::string potionName)
+    {
+        TraceSpan span("drink");
+        if (medicalBag.find(potionName)) {
+            auto &potion = medicalBag.getItem(potionName);
+            potion->useLogic(target);
+            output() << target.getName() << " drinks " << potionName << " from " << name << ".\n";
+            if (EventSink::active) {
+                EventSink::active->heal(id, target.getId(), potion->getId(), potion->getHealValue());
+                EventSink::active->itemConsumed(id, potion->getId());
+            }
+            medicalBag.removeItem(potionName);
+        } else {
+            errorCaught(ErrorReason::UnknownItem);
+        }
+
+    }
+
+};
+
+/**
+ * Child class of a character
+ * Allows to store and use spells
+ * @param spellBook - container for spell type items
+ * @see Character
+ * @see Container
+ * @see SpellBook
+ * @see Spell
+ */
+class SpellUser : virtual public Character
+{
+protected:
+    SpellBook spellBook;
+public:
+    SpellUser(std::string &n, int HP) : Character(n, HP), spellBook(0) {}
+
+    ~SpellUser()
+    {
+    }
+
+    bool isFull()
+    {
+        return spellBook.isFull();
+    }
+
+    //Getter
+    SpellBook &getSpellBook()
+    {
+        return spellBook;
+    }
+
+    /**
+     * Method for showing spells
+     * @param out Buffer to show the spells in
+     */
+    void showSpells(OutputBuffer &out = output())
+    {
+        for (const auto &spell: spellBook.toShow()) {
+            out << *spell.second << ' ';
+        }
+        out << '\n';
+    }
+
+    /**
+     * Method for casting spells on characters
+     * @param target Target character
+     * @param spellName Name of the spell to cast
+     */
+    void cast(Character &target, std::string spellName)
+    {
+        TraceSpan span("cast");
+        if (spellBook.find(spellName)) {
+            if (spellBook.getItem(spellName)->isTargetInList(target)) {
+                auto &spell = spellBook.getItem(spellName);
+                int damage = target.getHP();
+                spell->useLogic(target);
+                output() << name << " casts " << spellName << " on " << target.getName() << "!\n";
+                if (EventSink::active) {
+                    EventSink::active->damage(id, target.getId(), spell->getId(), damage);
+                    EventSink::active->itemConsumed(id, spell->getId());
+                }
+                spellBook.removeItem(spellName);
+            } else {
+                errorCaught(ErrorReason::TargetNotAllowed);
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownItem);
+        }
+    }
+
+};
+
+/**
+ * Child class of a WeaponUser and PotionUser
+ * @param maxAllowedWeapons - size of arsenal
+ * @param maxAllowedPotions - size of medicalBag
+ */
+class Fighter : public WeaponUser, public PotionUser
+{
+public:
+    const int maxAllowedWeapons = 3;
+    const int maxAllowedPotions = 5;
+
+    Fighter(std::string &n, int HP) : Character(n, HP), PotionUser(n, HP), WeaponUser(n, HP)
+    {
+        output() << "A new fighter came to town, " << name << ".\n";
+        arsenal.resizeContainer(maxAllowedWeapons);
+        medicalBag.resizeContainer(maxAllowedPotions);
+    }
+
+    ~Fighter() = default;
+
+    void obtainItem(const std::shared_ptr<const PhysicalItem> &item) override
+    {
+        if (auto potion = std::dynamic_pointer_cast<const Potion>(item)) {
+            medicalBag.addItem(potion);
+        } else if (auto weapon = std::dynamic_pointer_cast<const Weapon>(item)) {
+            arsenal.addItem(weapon);
+        }
+    }
+
+    std::string getRole() const override
+    {
+        return "fighter";
+    }
+
+private:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ":fighter:" << healthPoints;
+    }
+
+};
+
+/**
+ * Child class of a WeaponUser, PotionUser and SpellUser
+ * @param maxAllowedWeapons - size of arsenal
+ * @param maxAllowedPotions - size of medicalBag
+ * @param maxAllowedSpells - size of spellBook
+ */
+class Archer : public WeaponUser, public PotionUser, public SpellUser
+{
+public:
+    const int maxAllowedWeapons = 2;
+    const int maxAllowedPotions = 3;
+    const int maxAllowedSpells = 2;
+
+    Archer(std::string &n, int HP) : Character(n, HP), PotionUser(n, HP), WeaponUser(n, HP), SpellUser(n, HP)
+    {
+        output() << "A new archer came to town, " << name << ".\n";
+        arsenal.resizeContainer(maxAllowedWeapons);
+        medicalBag.resizeContainer(maxAllowedPotions);
+        spellBook.resizeContainer(maxAllowedSpells);
+    }
+
+    ~Archer() = default;
+
+    void obtainItem(const std::shared_ptr<const PhysicalItem> &item) override
+    {
+        if (auto potion = std::dynamic_pointer_cast<const Potion>(item)) {
+            medicalBag.addItem(potion);
+        } else if (auto weapon = std::dynamic_pointer_cast<const Weapon>(item)) {
+            arsenal.addItem(weapon);
+        } else if (auto spell = std::dynamic_pointer_cast<const Spell>(item)) {
+            spellBook.addItem(spell);
+        }
+    }
+
+    std::string getRole() const override
+    {
+        return "archer";
+    }
+
+private:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ":archer:" << healthPoints;
+    }
+
+};
+
+/**
+ * Child class of a PotionUser and SpellUser
+ * @param maxAllowedPotions - size of medicalBag
+ * @param maxAllowedSpells - size of spellBook
+ */
+class Wizard : public PotionUser, public SpellUser
+{
+public:
+    const int maxAllowedPotions = 10;
+    const int maxAllowedSpells = 10;
+
+    Wizard(std::string &n, int HP) : Character(n, HP), PotionUser(n, HP), SpellUser(n, HP)
+    {
+        output() << "A new wizard came to town, " << name << ".\n";
+        medicalBag.resizeContainer(maxAllowedPotions);
+        spellBook.resizeContainer(maxAllowedSpells);
+    }
+
+    ~Wizard() = default;
+
+    void obtainItem(const std::shared_ptr<const PhysicalItem> &item) override
+    {
+        if (auto potion = std::dynamic_pointer_cast<const Potion>(item)) {
+            medicalBag.addItem(potion);
+        } else if (auto spell = std::dynamic_pointer_cast<const Spell>(item)) {
+            spellBook.addItem(spell);
+        }
+    }
+
+    std::string getRole() const override
+    {
+        return "wizard";
+    }
+
+private:
+    void writeTo(OutputBuffer &out) const override
+    {
+        out << name << ":wizard:" << healthPoints;
+    }
+
+};
+
+/**
+ * Gets the container a character keeps items of type T in
+ * @param character Owner of the container
+ * @return The container, or nullptr if the character can not hold such items
+ */
+template<DerivedFromPhysicalItem T>
+Container<T> *inventoryOf(Character &character)
+{
+    if constexpr (std::is_same_v<T, Weapon>) {
+        auto weaponUser = dynamic_cast<WeaponUser *>(&character);
+        return weaponUser ? &weaponUser->getArsenal() : nullptr;
+    } else if constexpr (std::is_same_v<T, Potion>) {
+        auto potionUser = dynamic_cast<PotionUser *>(&character);
+        return potionUser ? &potionUser->getMedicalBag() : nullptr;
+    } else {
+        auto spellUser = dynamic_cast<SpellUser *>(&character);
+        return spellUser ? &spellUser->getSpellBook() : nullptr;
+    }
+}
@@ -0,0 +1,11 @@
+#include "Events.h"
+
+using namespace std;
+
+void errorCaught(ErrorReason reason)
+{
+    output() << "Error caught\n";
+    if (EventSink::active) {
+        EventSink::active->error(reason);
+    }
+}
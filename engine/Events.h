@@ -0,0 +1,302 @@
+#pragma once
+
+#include "Output.h"
+
+/**
+ * Types of the events in the structured event stream
+ */
+enum class EventType : uint8_t
+{
+    Created = 1,
+    Damage,
+    Heal,
+    ItemObtained,
+    ItemConsumed,
+    Death,
+    Dialogue,
+    Error,
+    ItemTransferred
+};
+
+/**
+ * Reasons of the "Error caught" outputs, sent with the error events
+ */
+enum class ErrorReason : uint8_t
+{
+    UnknownCharacter = 1,
+    WrongRole,
+    InventoryFull,
+    UnknownItem,
+    InvalidValue,
+    TargetNotAllowed,
+    NameTaken
+};
+
+/**
+ * Optional machine-readable feed of everything that happens in the world, written
+ * next to the text output so that consumers do not have to parse it.
+ * Characters and items are referred to by integer IDs, names are only sent in the
+ * Created and ItemObtained events.
+ *
+ * Binary records are a packed header {uint8 type, uint8 code, uint16 textLength,
+ * int32 fields[4]} in native byte order followed by textLength bytes of text.
+ * NDJSON records are one JSON object per line.
+ * @param file - file the events are written to
+ * @param format - Binary or Ndjson
+ * @param buffer - events not written to the file yet
+ */
+class EventSink
+{
+public:
+    enum class Format
+    {
+        Binary,
+        Ndjson
+    };
+
+    /**
+     * Sink of the world executing commands on the current thread, if any
+     */
+    static inline thread_local EventSink *active = nullptr;
+
+private:
+    FILE *file;
+    Format format;
+    std::string buffer;
+    static constexpr size_t flushThreshold = 1 << 16;
+
+public:
+    /**
+     * Opens the file for the events
+     * @param path Path of the file
+     * @param format Format of the records
+     */
+    EventSink(const std::string &path, Format format) : file(fopen(path.c_str(), "wb")), format(format)
+    {
+        buffer.reserve(flushThreshold + 256);
+    }
+
+    ~EventSink()
+    {
+        flush();
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    EventSink(const EventSink &) = delete;
+
+    EventSink &operator=(const EventSink &) = delete;
+
+    bool isOpen() const
+    {
+        return file != nullptr;
+    }
+
+    /**
+     * Writes all buffered events to the file
+     */
+    void flush()
+    {
+        if (file && !buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), file);
+            fflush(file);
+        }
+        buffer.clear();
+    }
+
+    /**
+     * A character came to town
+     * @param id Character ID
+     * @param role 1 - fighter, 2 - archer, 3 - wizard
+     * @param HP Initial HP
+     * @param name Name of the character
+     */
+    void created(int id, int role, int HP, std::string_view name)
+    {
+        record(EventType::Created, role, id, HP, 0, 0, name);
+    }
+
+    /**
+     * A character damaged another one with an item
+     * @param source ID of the attacker
+     * @param target ID of the damaged character
+     * @param item ID of the weapon or spell
+     * @param amount Damage dealt
+     */
+    void damage(int source, int target, int item, int amount)
+    {
+        record(EventType::Damage, 0, source, target, item, amount, {});
+    }
+
+    /**
+     * A character was healed with a potion
+     * @param source ID of the owner of the potion
+     * @param target ID of the healed character
+     * @param item ID of the potion
+     * @param amount HP restored
+     */
+    void heal(int source, int target, int item, int amount)
+    {
+        record(EventType::Heal, 0, source, target, item, amount, {});
+    }
+
+    /**
+     * A character obtained a new item
+     * @param owner ID of the character
+     * @param item ID of the item
+     * @param kind 1 - weapon, 2 - potion, 3 - spell
+     * @param value Damage, heal value or number of allowed targets
+     * @param name Name of the item
+     */
+    void itemObtained(int owner, int item, int kind, int value, std::string_view name)
+    {
+        record(EventType::ItemObtained, kind, owner, item, value, 0, name);
+    }
+
+    /**
+     * A potion or a spell was used up
+     * @param owner ID of the character that had the item
+     * @param item ID of the item
+     */
+    void itemConsumed(int owner, int item)
+    {
+        record(EventType::ItemConsumed, 0, owner, item, 0, 0, {});
+    }
+
+    /**
+     * An item moved from one character to another
+     * @param from ID of the character that gave the item
+     * @param to ID of the character that got the item
+     * @param item ID of the item
+     */
+    void itemTransferred(int from, int to, int item)
+    {
+        record(EventType::ItemTransferred, 0, from, to, item, 0, {});
+    }
+
+    /**
+     * A character has died
+     * @param id ID of the character
+     */
+    void death(int id)
+    {
+        record(EventType::Death, 0, id, 0, 0, 0, {});
+    }
+
+    /**
+     * A character (or the narrator, ID 0) said something
+     * @param speaker ID of the speaker
+     * @param text The speech
+     */
+    void dialogue(int speaker, std::string_view text)
+    {
+        record(EventType::Dialogue, 0, speaker, 0, 0, 0, text);
+    }
+
+    /**
+     * A command failed with "Error caught"
+     * @param reason Why the command failed
+     */
+    void error(ErrorReason reason)
+    {
+        record(EventType::Error, static_cast<uint8_t>(reason), 0, 0, 0, 0, {});
+    }
+
+private:
+    void record(EventType type, uint8_t code, int a, int b, int c, int d, std::string_view text)
+    {
+        if (format == Format::Binary) {
+            struct
+            {
+                uint8_t type;
+                uint8_t code;
+                uint16_t textLength;
+                int32_t fields[4];
+            } header{static_cast<uint8_t>(type), code, static_cast<uint16_t>(std::min<size_t>(text.size(), 0xFFFF)),
+                     {a, b, c, d}};
+            buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+            buffer.append(text.data(), header.textLength);
+        } else {
+            switch (type) {
+                case EventType::Created:
+                    appendJson("{\"type\":\"created\",\"id\":", a);
+                    appendJson(",\"role\":", code);
+                    appendJson(",\"hp\":", b);
+                    appendJsonText(",\"name\":", text);
+                    break;
+                case EventType::Damage:
+                case EventType::Heal:
+                    buffer.append(type == EventType::Damage ? "{\"type\":\"damage\"" : "{\"type\":\"heal\"");
+                    appendJson(",\"source\":", a);
+                    appendJson(",\"target\":", b);
+                    appendJson(",\"item\":", c);
+                    appendJson(",\"amount\":", d);
+                    break;
+                case EventType::ItemObtained:
+                    appendJson("{\"type\":\"obtained\",\"owner\":", a);
+                    appendJson(",\"item\":", b);
+                    appendJson(",\"kind\":", code);
+                    appendJson(",\"value\":", c);
+                    appendJsonText(",\"name\":", text);
+                    break;
+                case EventType::ItemConsumed:
+                    appendJson("{\"type\":\"consumed\",\"owner\":", a);
+                    appendJson(",\"item\":", b);
+                    break;
+                case EventType::Death:
+                    appendJson("{\"type\":\"death\",\"id\":", a);
+                    break;
+                case EventType::Dialogue:
+                    appendJson("{\"type\":\"dialogue\",\"speaker\":", a);
+                    appendJsonText(",\"text\":", text);
+                    break;
+                case EventType::Error:
+                    appendJson("{\"type\":\"error\",\"reason\":", code);
+                    break;
+                case EventType::ItemTransferred:
+                    appendJson("{\"type\":\"transferred\",\"from\":", a);
+                    appendJson(",\"to\":", b);
+                    appendJson(",\"item\":", c);
+                    break;
+            }
+            buffer.append("}\n");
+        }
+        if (buffer.size() >= flushThreshold) {
+            flush();
+        }
+    }
+
+    void appendJson(const char *key, int value)
+    {
+        buffer.append(key);
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+    }
+
+    void appendJsonText(const char *key, std::string_view text)
+    {
+        buffer.append(key);
+        buffer.push_back('"');
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                buffer.push_back('\\');
+                buffer.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                buffer.append(escaped);
+            } else {
+                buffer.push_back(c);
+            }
+        }
+        buffer.push_back('"');
+    }
+};
+
+/**
+ * Reports a failed command to the output and to the event stream
+ * @param reason Why the command failed
+ */
+void errorCaught(ErrorReason reason);
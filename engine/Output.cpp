@@ -0,0 +1,41 @@
+#include "Output.h"
+
+using namespace std;
+
+OutputBuffer &output()
+{
+    static OutputBuffer standardOutput(stdout);
+    return OutputBuffer::active ? *OutputBuffer::active : standardOutput;
+}
+
+int toInt(string_view word)
+{
+    size_t start = 0;
+    while (start < word.size() && isspace(static_cast<unsigned char>(word[start]))) {
+        start++;
+    }
+    if (start < word.size() && word[start] == '+') {
+        start++;
+    }
+    int value = 0;
+    from_chars(word.data() + start, word.data() + word.size(), value);
+    return value;
+}
+
+void splitWords(string_view line, vector<string_view> &words)
+{
+    size_t position = 0;
+    while (true) {
+        while (position < line.size() && isspace(static_cast<unsigned char>(line[position]))) {
+            position++;
+        }
+        if (position == line.size()) {
+            return;
+        }
+        size_t start = position;
+        while (position < line.size() && !isspace(static_cast<unsigned char>(line[position]))) {
+            position++;
+        }
+        words.push_back(line.substr(start, position - start));
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <iostream>
+#include <utility>
+#include <concepts>
+#include <map>
+#include <set>
+#include <tuple>
+#include <optional>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <charconv>
+#include <string_view>
+#include <span>
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <bit>
+#include <deque>
+
+/**
+ * Buffer that all text output is formatted into. Numbers are written with to_chars
+ * and text is appended as is, so printing a line creates no temporary strings.
+ * A buffer attached to a file writes into it only when flushed, not on every line
+ * @param own - storage of the text when the caller does not provide a string
+ * @param text - formatted text not written yet, either own or a string of the caller
+ * @param file - where flush writes the text, nullptr for a buffer that only collects it
+ */
+class OutputBuffer
+{
+private:
+    std::string own;
+    std::string *text = &own;
+    FILE *file;
+public:
+    /**
+     * Buffer that the output of the current thread goes to, nullptr for the standard output
+     */
+    static inline thread_local OutputBuffer *active = nullptr;
+
+    static constexpr size_t flushThreshold = 1 << 16;
+
+    explicit OutputBuffer(FILE *file = nullptr) : file(file) {}
+
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    /**
+     * Buffer that appends to a string of the caller and never writes to a file
+     * @param target String the text is appended to
+     */
+    explicit OutputBuffer(std::string &target) : text(&target), file(nullptr) {}
+
+    OutputBuffer(OutputBuffer &&other) noexcept
+            : own(std::move(other.own)), text(other.text == &other.own ? &own : other.text), file(other.file)
+    {
+        other.text = &other.own;
+        other.file = nullptr;
+    }
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    OutputBuffer &operator<<(std::string_view value)
+    {
+        text->append(value);
+        return *this;
+    }
+
+    OutputBuffer &operator<<(const char *value)
+    {
+        text->append(value);
+        return *this;
+    }
+
+    OutputBuffer &operator<<(char value)
+    {
+        text->push_back(value);
+        return *this;
+    }
+
+    template<std::integral I> requires (!std::same_as<I, char> && !std::same_as<I, bool>)
+    OutputBuffer &operator<<(I value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text->append(digits, result.ptr);
+        return *this;
+    }
+
+    /**
+     * Makes room for at least size more characters
+     */
+    void reserve(size_t size)
+    {
+        text->reserve(text->size() + size);
+    }
+
+    //Getter
+    std::string &str()
+    {
+        return *text;
+    }
+
+    /**
+     * Writes the collected text to the file, if the buffer has one
+     */
+    void flush()
+    {
+        if (file && !text->empty()) {
+            fwrite(text->data(), 1, text->size(), file);
+            fflush(file);
+            text->clear();
+        }
+    }
+
+    /**
+     * Writes the collected text to the file once enough of it has been collected
+     */
+    void flushIfFull()
+    {
+        if (text->size() >= flushThreshold) {
+            flush();
+        }
+    }
+};
+
+/**
+ * @return Buffer the output of the current thread goes to
+ */
+OutputBuffer &output();
+
+/**
+ * Reads a number at the start of a word, like stoi
+ * @param word Word with the number
+ * @return The number, 0 if the word does not start with one
+ */
+int toInt(std::string_view word);
+
+/**
+ * Splits a line into words separated by whitespace, like reading it with >>
+ * @param line The line
+ * @param words Where to add views of the words, pointing into the line
+ */
+void splitWords(std::string_view line, std::vector<std::string_view> &words);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Characters.h"
+
+/**
+ * Index of characters kept up to date on every creation, death and HP change,
+ * so that roster queries cost O(log n + k) for k results instead of a full scan
+ * @param byHP - characters ordered by HP, ties broken by name
+ * @param byRole - characters of every role, ordered by name
+ */
+class RosterIndex
+{
+private:
+    std::map<std::pair<int, std::string>, Character *> byHP;
+    std::map<std::string, std::map<std::string, Character *>> byRole;
+public:
+    RosterIndex() = default;
+
+    ~RosterIndex() = default;
+
+    /**
+     * Starts tracking a character
+     * @param character Character to track
+     */
+    void add(Character &character)
+    {
+        character.rosterIndex = this;
+        byHP[{character.healthPoints, character.name}] = &character;
+        byRole[character.getRole()][character.name] = &character;
+    }
+
+    /**
+     * Stops tracking a character
+     * @param character Character to forget
+     */
+    void remove(Character &character)
+    {
+        if (character.rosterIndex != this) {
+            return;
+        }
+        character.rosterIndex = nullptr;
+        byHP.erase({character.healthPoints, character.name});
+        auto role = byRole.find(character.getRole());
+        if (role != byRole.end()) {
+            role->second.erase(character.name);
+        }
+    }
+
+    /**
+     * Moves a character to its new position in the HP order
+     * @param character Character whose HP changed
+     * @param oldHP HP before the change
+     */
+    void updateHP(Character &character, int oldHP)
+    {
+        auto node = byHP.extract({oldHP, character.name});
+        if (node.empty()) {
+            return;
+        }
+        node.key().first = character.healthPoints;
+        byHP.insert(std::move(node));
+    }
+
+    /**
+     * Visits up to k characters with the lowest HP, weakest first
+     * @param k Number of characters to visit
+     * @param visit Function called for every character
+     */
+    template<typename F>
+    void weakest(int k, F visit)
+    {
+        for (auto it = byHP.begin(); it != byHP.end() && k > 0; ++it, --k) {
+            visit(*it->second);
+        }
+    }
+
+    /**
+     * Visits up to k characters with the highest HP, strongest first
+     * @param k Number of characters to visit
+     * @param visit Function called for every character
+     */
+    template<typename F>
+    void strongest(int k, F visit)
+    {
+        for (auto it = byHP.rbegin(); it != byHP.rend() && k > 0; ++it, --k) {
+            visit(*it->second);
+        }
+    }
+
+    /**
+     * Visits all characters with minHP <= HP <= maxHP in HP order
+     * @param minHP Lower bound of the range
+     * @param maxHP Upper bound of the range
+     * @param visit Function called for every character
+     */
+    template<typename F>
+    void inRange(int minHP, int maxHP, F visit)
+    {
+        auto it = byHP.lower_bound({minHP, std::string()});
+        for (; it != byHP.end() && it->first.first <= maxHP; ++it) {
+            visit(*it->second);
+        }
+    }
+
+    /**
+     * Visits all characters of a role in name order
+     * @param role Role to look for
+     * @param visit Function called for every character
+     */
+    template<typename F>
+    void withRole(const std::string &role, F visit)
+    {
+        auto it = byRole.find(role);
+        if (it == byRole.end()) {
+            return;
+        }
+        for (const auto &character: it->second) {
+            visit(*character.second);
+        }
+    }
+};
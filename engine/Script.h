@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Tracing.h"
+
+#include <cctype>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * Input script read as a stream of chunks and tokenized by several threads at once.
+ * The text after the header is cut into chunks at line boundaries, the chunks are
+ * split into words by a pool of long-lived tokenizer threads, and the commands are
+ * handed out strictly in the original order. Only a window of chunks ahead of the one being executed is read,
+ * and a chunk is freed as soon as its commands have run, so memory stays bounded
+ * however long the script is.
+ * Words are views into the text of their chunk, so no string is created per word
+ * @param file - the input
+ * @param pending - text read from the file but not given to a chunk yet
+ * @param commandCount - number of lines to run: the rest of the header line and n more, like main() always did
+ * @param window - chunks read ahead of execution, in order
+ * @param chunkSize - approximate size of a chunk; inputs smaller than this are tokenized by a single thread
+ * @param windowSize - number of chunks tokenized ahead of execution, also the number of tokenizer threads
+ * @param chunksRead - number of chunks made so far, numbers the parse spans in the trace
+ * @param jobs - chunks waiting for a tokenizer thread, guarded by jobsMutex
+ * @param tokenizers - the tokenizer threads, started with the first chunk that needs one
+ */
+class Script
+{
+private:
+    /**
+     * Tokenized part of the input
+     * @param text - the lines of the chunk
+     * @param words - words of all lines of the chunk
+     * @param lineEnds - for every line, index in words after its last word
+     * @param index - number of the chunk in the script
+     * @param ready - set once the chunk is tokenized
+     */
+    struct Chunk
+    {
+        std::string text;
+        std::vector<std::string_view> words;
+        std::vector<size_t> lineEnds;
+        uint64_t index = 0;
+        std::atomic<bool> ready{false};
+    };
+
+    FILE *file = nullptr;
+    std::string pending;
+    long long commandCount = 0;
+    std::deque<std::unique_ptr<Chunk>> window;
+    static constexpr size_t chunkSize = 1 << 20;
+    const size_t windowSize = std::max(2u, std::thread::hardware_concurrency());
+    uint64_t chunksRead = 0;
+    std::deque<Chunk *> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsChanged;
+    bool closing = false;
+    std::vector<std::thread> tokenizers;
+
+public:
+    Script() = default;
+
+    ~Script()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            closing = true;
+        }
+        jobsChanged.notify_all();
+        for (auto &tokenizer: tokenizers) {
+            tokenizer.join();
+        }
+    }
+
+    Script(const Script &) = delete;
+
+    Script &operator=(const Script &) = delete;
+
+    /**
+     * Reads the header and starts tokenizing the first chunks of the input
+     * @param input File to read
+     */
+    void load(FILE *input)
+    {
+        file = input;
+        //Header, read the way cin >> n does
+        size_t position = 0;
+        while (true) {
+            while (position < pending.size() && std::isspace(static_cast<unsigned char>(pending[position]))) {
+                position++;
+            }
+            if ((position < pending.size() && pending.find('\n', position) != std::string::npos) || !readBlock()) {
+                break;
+            }
+        }
+        if (position < pending.size() && pending[position] == '+') {
+            position++;
+        }
+        int n = 0;
+        auto result = std::from_chars(pending.data() + position, pending.data() + pending.size(), n);
+        if (result.ec != std::errc()) {
+            return;
+        }
+        pending.erase(0, result.ptr - pending.data());
+        commandCount = static_cast<long long>(n) + 1;
+        fillWindow();
+    }
+
+    /**
+     * Runs every command of the script in order, skipping empty lines
+     * @param run Called with the words of every command
+     */
+    template<typename F>
+    void forEachCommand(F run)
+    {
+        long long remaining = commandCount;
+        while (remaining > 0 && !window.empty()) {
+            auto chunk = std::move(window.front());
+            window.pop_front();
+            chunk->ready.wait(false, std::memory_order_acquire);
+            size_t firstWord = 0;
+            for (size_t lineEnd: chunk->lineEnds) {
+                if (remaining-- <= 0) {
+                    break;
+                }
+                if (lineEnd > firstWord) {
+                    run(std::span<const std::string_view>(chunk->words).subspan(firstWord, lineEnd - firstWord));
+                }
+                firstWord = lineEnd;
+            }
+            chunk.reset();
+            fillWindow();
+        }
+    }
+
+private:
+    /**
+     * Appends the next block of the file to pending
+     * @return false at the end of the file
+     */
+    bool readBlock()
+    {
+        if (!file) {
+            return false;
+        }
+        char block[1 << 16];
+        size_t size = fread(block, 1, sizeof(block), file);
+        if (size == 0) {
+            file = nullptr;
+            return false;
+        }
+        pending.append(block, size);
+        return true;
+    }
+
+    /**
+     * Reads and starts tokenizing chunks until the window is full or the input ends.
+     * A chunk ends at the last line break of at least chunkSize bytes of text
+     */
+    void fillWindow()
+    {
+        while (window.size() < windowSize) {
+            while (pending.size() < chunkSize && readBlock()) {
+            }
+            size_t end = pending.size();
+            if (file) {
+                size_t lineBreak = pending.rfind('\n');
+                while (lineBreak == std::string::npos && readBlock()) {
+                    lineBreak = pending.rfind('\n');
+                }
+                end = lineBreak == std::string::npos ? pending.size() : lineBreak + 1;
+            }
+            if (end == 0) {
+                return;
+            }
+            auto chunk = std::make_unique<Chunk>();
+            chunk->text.assign(pending, 0, end);
+            chunk->index = chunksRead++;
+            pending.erase(0, end);
+            //The only chunk of a small input is not worth a thread
+            if (!file && pending.empty() && window.empty() && tokenizers.empty()) {
+                tokenize(*chunk);
+            } else {
+                if (tokenizers.empty()) {
+                    for (size_t i = 0; i < windowSize; i++) {
+                        tokenizers.emplace_back([this] { tokenizeJobs(); });
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(jobsMutex);
+                    jobs.push_back(chunk.get());
+                }
+                jobsChanged.notify_one();
+            }
+            window.push_back(std::move(chunk));
+        }
+    }
+
+    /**
+     * Main loop of a tokenizer thread
+     */
+    void tokenizeJobs()
+    {
+        while (true) {
+            Chunk *chunk;
+            {
+                std::unique_lock<std::mutex> lock(jobsMutex);
+                jobsChanged.wait(lock, [this] { return closing || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                chunk = jobs.front();
+                jobs.pop_front();
+            }
+            tokenize(*chunk);
+        }
+    }
+
+    /**
+     * Splits every line of a chunk into words. Only every sampleEvery-th chunk is traced,
+     * numbered by its index rather than by the commands of the thread
+     */
+    static void tokenize(Chunk &chunk)
+    {
+        uint64_t start = Tracer::enabled && chunk.index % Tracer::sampleEvery == 0 ? Tracer::now() : 0;
+        std::string_view rest = chunk.text;
+        while (!rest.empty()) {
+            size_t end = rest.find('\n');
+            std::string_view line = rest.substr(0, end);
+            splitWords(line, chunk.words);
+            chunk.lineEnds.push_back(chunk.words.size());
+            rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+        }
+        if (start) {
+            Tracer::record("parse", start, Tracer::now(), chunk.index);
+        }
+        chunk.ready.store(true, std::memory_order_release);
+        chunk.ready.notify_one();
+    }
+};
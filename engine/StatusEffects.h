@@ -0,0 +1,232 @@
+#pragma once
+
+#include "Characters.h"
+
+/**
+ * Damage-over-time and heal-over-time effects on characters.
+ * Effects are kept in a hierarchical timing wheel of 4 levels by 64 slots, so
+ * scheduling, cancelling and expiring an effect are all O(1) no matter how many
+ * characters exist; only the effects that are due in a tick are ever touched.
+ * Effects that are further away than the wheel covers wait in the top level and
+ * are cascaded again until they fit
+ * @param levels - slots of the wheel, every slot is a circular list with a sentinel node
+ * @param byTarget - first effect of every character that has any
+ * @param now - current tick
+ */
+class StatusEffects
+{
+public:
+    enum class Kind
+    {
+        Poison,
+        Regeneration
+    };
+
+private:
+    struct Link
+    {
+        Link *prev = this;
+        Link *next = this;
+    };
+
+    /**
+     * Active effect, linked into a wheel slot and into the list of effects of its target
+     */
+    struct Effect : Link
+    {
+        Effect *prevOfTarget = nullptr;
+        Effect *nextOfTarget = nullptr;
+        unsigned long long expires = 0;
+        Character *target = nullptr;
+        Kind kind = Kind::Poison;
+        int value = 0;
+        int period = 0;
+        int remaining = 0;
+    };
+
+    static constexpr int levelBits = 6;
+    static constexpr int slotsPerLevel = 1 << levelBits;
+    static constexpr int levelCount = 4;
+
+    Link levels[levelCount][slotsPerLevel];
+    std::unordered_map<Character *, Effect *> byTarget;
+    unsigned long long now = 0;
+
+public:
+    StatusEffects() = default;
+
+    ~StatusEffects()
+    {
+        for (auto &target: byTarget) {
+            Effect *effect = target.second;
+            while (effect) {
+                Effect *next = effect->nextOfTarget;
+                delete effect;
+                effect = next;
+            }
+        }
+    }
+
+    StatusEffects(const StatusEffects &) = delete;
+
+    StatusEffects &operator=(const StatusEffects &) = delete;
+
+    /**
+     * Puts a new effect on a character
+     * @param target Character to affect
+     * @param kind Poison or Regeneration
+     * @param value Damage or heal applied every period
+     * @param period Number of ticks between two applications
+     * @param times Number of applications
+     */
+    void apply(Character &target, Kind kind, int value, int period, int times)
+    {
+        auto effect = new Effect;
+        effect->target = &target;
+        effect->kind = kind;
+        effect->value = value;
+        effect->period = period;
+        effect->remaining = times;
+        Effect *&head = byTarget[&target];
+        effect->nextOfTarget = head;
+        if (head) {
+            head->prevOfTarget = effect;
+        }
+        head = effect;
+        schedule(effect, now + period);
+    }
+
+    /**
+     * Removes all effects of a character, e.g. when it dies
+     * @param target Character to cure
+     */
+    void cancelAll(Character &target)
+    {
+        auto it = byTarget.find(&target);
+        if (it == byTarget.end()) {
+            return;
+        }
+        Effect *effect = it->second;
+        byTarget.erase(it);
+        while (effect) {
+            Effect *next = effect->nextOfTarget;
+            unlink(effect);
+            delete effect;
+            effect = next;
+        }
+    }
+
+    /**
+     * Moves time one tick forward and applies all effects that are due
+     * @param applied Called as applied(target, kind, value) after every application,
+     * may cancel effects of the target
+     */
+    template<typename F>
+    void advance(F applied)
+    {
+        now++;
+        int cascadeUpTo = 0;
+        while (cascadeUpTo + 1 < levelCount && slotIndex(now, cascadeUpTo) == 0) {
+            cascadeUpTo++;
+        }
+        for (int level = cascadeUpTo; level > 0; level--) {
+            Link pending;
+            moveAll(levels[level][slotIndex(now, level)], pending);
+            while (pending.next != &pending) {
+                auto effect = static_cast<Effect *>(pending.next);
+                unlink(effect);
+                schedule(effect, effect->expires);
+            }
+        }
+        Link due;
+        moveAll(levels[0][slotIndex(now, 0)], due);
+        while (due.next != &due) {
+            auto effect = static_cast<Effect *>(due.next);
+            unlink(effect);
+            if (effect->expires != now) {
+                schedule(effect, effect->expires);
+                continue;
+            }
+            Character &target = *effect->target;
+            Kind kind = effect->kind;
+            int value = effect->value;
+            if (--effect->remaining > 0) {
+                schedule(effect, now + effect->period);
+            } else {
+                forget(effect);
+            }
+            if (kind == Kind::Poison) {
+                target.takeDamage(value);
+            } else {
+                target.heal(value);
+            }
+            applied(target, kind, value);
+        }
+    }
+
+private:
+    static int slotIndex(unsigned long long tick, int level)
+    {
+        return static_cast<int>((tick >> (level * levelBits)) & (slotsPerLevel - 1));
+    }
+
+    /**
+     * Links an effect into the slot where it expires, or as close to it as the wheel reaches
+     */
+    void schedule(Effect *effect, unsigned long long expires)
+    {
+        effect->expires = expires;
+        unsigned long long delay = expires - now;
+        int level = 0;
+        while (level + 1 < levelCount && delay >= (1ULL << ((level + 1) * levelBits))) {
+            level++;
+        }
+        if (delay >= (1ULL << (levelCount * levelBits))) {
+            expires = now + (1ULL << (levelCount * levelBits)) - 1;
+        }
+        Link &slot = levels[level][slotIndex(expires, level)];
+        effect->prev = slot.prev;
+        effect->next = &slot;
+        slot.prev->next = effect;
+        slot.prev = effect;
+    }
+
+    static void unlink(Link *link)
+    {
+        link->prev->next = link->next;
+        link->next->prev = link->prev;
+        link->prev = link;
+        link->next = link;
+    }
+
+    static void moveAll(Link &from, Link &to)
+    {
+        if (from.next == &from) {
+            return;
+        }
+        to.next = from.next;
+        to.prev = from.prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        from.next = &from;
+        from.prev = &from;
+    }
+
+    /**
+     * Deletes an expired effect that is no longer linked into the wheel
+     */
+    void forget(Effect *effect)
+    {
+        if (effect->prevOfTarget) {
+            effect->prevOfTarget->nextOfTarget = effect->nextOfTarget;
+        } else if (effect->nextOfTarget) {
+            byTarget[effect->target] = effect->nextOfTarget;
+        } else {
+            byTarget.erase(effect->target);
+        }
+        if (effect->nextOfTarget) {
+            effect->nextOfTarget->prevOfTarget = effect->prevOfTarget;
+        }
+        delete effect;
+    }
+};
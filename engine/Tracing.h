@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Output.h"
+
+/**
+ * Optional timeline of command execution, dumped at exit in the Chrome trace event
+ * format for chrome://tracing or Perfetto.
+ * Every thread records its spans into its own ring buffer, so recording takes no locks.
+ * A buffer grows with the spans recorded into it up to bufferCapacity, after which the
+ * oldest spans are overwritten. Only every sampleEvery-th
+ * command of a thread is recorded, which keeps tracing of huge scripts cheap
+ * @param enabled - whether tracing is on, set once before any command runs
+ * @param sampleEvery - sampling period in commands
+ * @param sampled - whether the current command of this thread is being recorded
+ * @param buffers - ring buffers of all threads that recorded something
+ */
+class Tracer
+{
+public:
+    /**
+     * A finished span
+     * @param name - what was being done
+     * @param start, duration - in nanoseconds of the steady clock
+     * @param command - number of the command on its thread
+     */
+    struct Span
+    {
+        const char *name;
+        uint64_t start;
+        uint64_t duration;
+        uint64_t command;
+    };
+
+    static inline bool enabled = false;
+    static inline uint64_t sampleEvery = 1;
+    static inline thread_local bool sampled = false;
+    static constexpr size_t bufferCapacity = 1 << 18;
+
+private:
+    struct ThreadBuffer
+    {
+        std::vector<Span> spans;
+        uint64_t written = 0;
+        uint64_t commands = 0;
+        int threadId = 0;
+        ThreadBuffer *next = nullptr;
+    };
+
+    static inline std::atomic<ThreadBuffer *> buffers{nullptr};
+    static inline std::atomic<int> threadCount{0};
+
+    /**
+     * @return Ring buffer of the current thread, created on first use and kept until exit
+     */
+    static ThreadBuffer &local()
+    {
+        static thread_local ThreadBuffer *buffer = nullptr;
+        if (!buffer) {
+            buffer = new ThreadBuffer;
+            buffer->threadId = ++threadCount;
+            buffer->next = buffers.load(std::memory_order_relaxed);
+            while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            }
+        }
+        return *buffer;
+    }
+
+public:
+    //Getter
+    static uint64_t now()
+    {
+        auto time = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+    /**
+     * Marks the start of a new command on this thread and decides whether it is recorded
+     */
+    static void beginCommand()
+    {
+        if (!enabled) {
+            return;
+        }
+        auto &buffer = local();
+        sampled = buffer.commands++ % sampleEvery == 0;
+    }
+
+    /**
+     * Records a finished span of the current command
+     * @param name Static name of the span
+     * @param start Start time from now()
+     * @param end End time from now()
+     */
+    static void record(const char *name, uint64_t start, uint64_t end)
+    {
+        record(name, start, end, local().commands - 1);
+    }
+
+    /**
+     * Records a finished span that belongs to something else than a command of this thread
+     * @param name Static name of the span
+     * @param start Start time from now()
+     * @param end End time from now()
+     * @param command Number shown as the command of the span
+     */
+    static void record(const char *name, uint64_t start, uint64_t end, uint64_t command)
+    {
+        auto &buffer = local();
+        Span span{name, start, end - start, command};
+        if (buffer.spans.size() < bufferCapacity) {
+            buffer.spans.push_back(span);
+        } else {
+            buffer.spans[buffer.written % bufferCapacity] = span;
+        }
+        buffer.written++;
+    }
+
+    /**
+     * Writes all recorded spans as Chrome trace event JSON. Must be called when no thread records anymore
+     * @param path File to write to
+     * @return false if the file can not be written
+     */
+    static bool dump(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "w");
+        if (!file) {
+            return false;
+        }
+        fputs("{\"traceEvents\":[", file);
+        bool first = true;
+        for (auto buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            uint64_t begin = buffer->written > bufferCapacity ? buffer->written - bufferCapacity : 0;
+            for (uint64_t i = begin; i < buffer->written; i++) {
+                const Span &span = buffer->spans[i % bufferCapacity];
+                fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                              "\"dur\":%.3f,\"args\":{\"command\":%llu}}",
+                        first ? "" : ",", span.name, buffer->threadId, span.start / 1000.0, span.duration / 1000.0,
+                        static_cast<unsigned long long>(span.command));
+                first = false;
+            }
+        }
+        fputs("\n]}\n", file);
+        return fclose(file) == 0;
+    }
+};
+
+/**
+ * Records the time from its creation to its destruction as a span of the current
+ * command, if the command is sampled
+ * @param name - static name of the span
+ * @param start - start time, 0 if the span is not recorded
+ */
+class TraceSpan
+{
+private:
+    const char *name;
+    uint64_t start;
+public:
+    explicit TraceSpan(const char *name) : name(name), start(Tracer::sampled ? Tracer::now() : 0) {}
+
+    ~TraceSpan()
+    {
+        if (start) {
+            Tracer::record(name, start, Tracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    TraceSpan &operator=(const TraceSpan &) = delete;
+};
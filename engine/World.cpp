@@ -0,0 +1,1047 @@
+#include "World.h"
+
+using namespace std;
+
+void WorldSnapshot::show(const string &command, ostream &os) const
+{
+    vector<string> words;
+    istringstream iss(command);
+    string word;
+    while (iss >> word) {
+        words.push_back(word);
+    }
+    if (words.size() < 2 || words[0] != "Show") {
+        os << "Error caught" << endl;
+        return;
+    }
+    if (words[1] == "characters") {
+        vector<const Bucket::value_type *> all;
+        for (const auto &bucket: buckets) {
+            for (const auto &entry: *bucket) {
+                all.push_back(&entry);
+            }
+        }
+        sort(all.begin(), all.end(), [](auto a, auto b) { return a->first < b->first; });
+        for (auto entry: all) {
+            os << entry->second.character << " ";
+        }
+        os << endl;
+        return;
+    }
+    if (words.size() < 3 || (words[1] == "hp" && words.size() < 4)) {
+        os << "Error caught" << endl;
+        return;
+    }
+    if (words[1] == "weakest" || words[1] == "strongest") {
+        int k = toInt(words[2]);
+        if (k < 0) {
+            os << "Error caught" << endl;
+            return;
+        }
+        auto all = byHP();
+        if (words[1] == "strongest") {
+            reverse(all.begin(), all.end());
+        }
+        for (size_t i = 0; i < all.size() && i < static_cast<size_t>(k); i++) {
+            os << all[i].second->second.character << " ";
+        }
+        os << endl;
+        return;
+    }
+    if (words[1] == "hp") {
+        int minHP = toInt(words[2]);
+        int maxHP = toInt(words[3]);
+        if (minHP > maxHP) {
+            os << "Error caught" << endl;
+            return;
+        }
+        for (const auto &entry: byHP()) {
+            if (entry.first >= minHP && entry.first <= maxHP) {
+                os << entry.second->second.character << " ";
+            }
+        }
+        os << endl;
+        return;
+    }
+    if (words[1] == "role") {
+        if (words[2] != "fighter" && words[2] != "archer" && words[2] != "wizard") {
+            os << "Error caught" << endl;
+            return;
+        }
+        vector<const Bucket::value_type *> matching;
+        for (const auto &bucket: buckets) {
+            for (const auto &entry: *bucket) {
+                if (entry.second.role == words[2]) {
+                    matching.push_back(&entry);
+                }
+            }
+        }
+        sort(matching.begin(), matching.end(), [](auto a, auto b) { return a->first < b->first; });
+        for (auto entry: matching) {
+            os << entry->second.character << " ";
+        }
+        os << endl;
+        return;
+    }
+    const auto &bucket = *buckets[bucketOf(words[2], buckets.size())];
+    auto it = bucket.find(words[2]);
+    const string *line = nullptr;
+    if (it != bucket.end()) {
+        if (words[1] == "weapons") {
+            line = &it->second.weapons;
+        } else if (words[1] == "potions") {
+            line = &it->second.potions;
+        } else if (words[1] == "spells") {
+            line = &it->second.spells;
+        }
+    }
+    if (line && !line->empty()) {
+        os << *line;
+    } else {
+        os << "Error caught" << endl;
+    }
+}
+
+vector<pair<int, const WorldSnapshot::Bucket::value_type *>> WorldSnapshot::byHP() const
+{
+    vector<pair<int, const Bucket::value_type *>> all;
+    for (const auto &bucket: buckets) {
+        for (const auto &entry: *bucket) {
+            all.emplace_back(entry.second.HP, &entry);
+        }
+    }
+    sort(all.begin(), all.end(), [](const auto &a, const auto &b) {
+        return a.first != b.first ? a.first < b.first : a.second->first < b.second->first;
+    });
+    return all;
+}
+
+shared_ptr<const WorldSnapshot> World::takeSnapshot()
+{
+    TraceSpan span("snapshot");
+    WorldSnapshot::Buckets buckets;
+    //Case for the first snapshot and for a roster grown past twice what the buckets were made for
+    if (!lastSnapshot || characters.size() > lastSnapshot->getBuckets().size() * WorldSnapshot::bucketSize * 2) {
+        size_t bucketCount = WorldSnapshot::bucketCountFor(characters.size());
+        vector<WorldSnapshot::Bucket> fresh(bucketCount);
+        for (const auto &character: characters) {
+            fresh[WorldSnapshot::bucketOf(character.first, bucketCount)].emplace(character.first,
+                                                                                render(*character.second));
+        }
+        buckets.reserve(bucketCount);
+        for (auto &bucket: fresh) {
+            buckets.push_back(make_shared<const WorldSnapshot::Bucket>(std::move(bucket)));
+        }
+    } else {
+        buckets = lastSnapshot->getBuckets();
+        map<size_t, shared_ptr<WorldSnapshot::Bucket>> copied;
+        for (const auto &name: changed) {
+            size_t index = WorldSnapshot::bucketOf(name, buckets.size());
+            auto &bucket = copied[index];
+            if (!bucket) {
+                bucket = make_shared<WorldSnapshot::Bucket>(*buckets[index]);
+            }
+            auto it = characters.find(name);
+            if (it != characters.end() && it->second) {
+                bucket->insert_or_assign(name, render(*it->second));
+            } else {
+                bucket->erase(name);
+            }
+        }
+        for (auto &bucket: copied) {
+            buckets[bucket.first] = std::move(bucket.second);
+        }
+    }
+    changed.clear();
+    lastSnapshot = make_shared<const WorldSnapshot>(std::move(buckets));
+    return lastSnapshot;
+}
+
+WorldSnapshot::Entry World::render(Character &character)
+{
+    WorldSnapshot::Entry entry;
+    OutputBuffer line;
+    line << character;
+    entry.character = std::move(line.str());
+    if (auto weaponUser = dynamic_cast<WeaponUser *>(&character)) {
+        OutputBuffer weapons;
+        weaponUser->showWeapons(weapons);
+        entry.weapons = std::move(weapons.str());
+    }
+    if (auto potionUser = dynamic_cast<PotionUser *>(&character)) {
+        OutputBuffer potions;
+        potionUser->showPotions(potions);
+        entry.potions = std::move(potions.str());
+    }
+    if (auto spellUser = dynamic_cast<SpellUser *>(&character)) {
+        OutputBuffer spells;
+        spellUser->showSpells(spells);
+        entry.spells = std::move(spells.str());
+    }
+    entry.role = character.getRole();
+    entry.HP = character.getHP();
+    return entry;
+}
+
+void World::touch(const string &name)
+{
+    if (lastSnapshot) {
+        changed.insert(name);
+    }
+}
+
+void World::execute(string_view command)
+{
+    if (command.empty()) {
+        return;
+    }
+    Tracer::beginCommand();
+    TraceSpan commandSpan("command");
+    vector<string_view> words;
+    {
+        TraceSpan span("parse");
+        splitWords(command, words);
+    }
+    run(words);
+}
+
+void World::execute(string_view command, string &out)
+{
+    OutputBuffer buffer(out);
+    OutputBuffer *previous = exchange(OutputBuffer::active, &buffer);
+    execute(command);
+    OutputBuffer::active = previous;
+}
+
+void World::executeBatch(span<const string_view> commands, string &out)
+{
+    OutputBuffer buffer(out);
+    OutputBuffer *previous = exchange(OutputBuffer::active, &buffer);
+    for (string_view command: commands) {
+        execute(command);
+    }
+    OutputBuffer::active = previous;
+}
+
+void World::finish()
+{
+    if (roundOpen) {
+        roundOpen = false;
+        EventSink::active = events;
+        resolveRound();
+        output().flushIfFull();
+    }
+}
+
+void World::finish(string &out)
+{
+    OutputBuffer buffer(out);
+    OutputBuffer *previous = exchange(OutputBuffer::active, &buffer);
+    finish();
+    OutputBuffer::active = previous;
+}
+
+void World::execute(span<const string_view> words)
+{
+    Tracer::beginCommand();
+    TraceSpan commandSpan("command");
+    run(words);
+}
+
+void World::run(span<const string_view> words)
+{
+    if (words.empty()) {
+        return;
+    }
+    EventSink::active = events;
+    {
+        TraceSpan span("dispatch");
+        dispatch(words);
+    }
+    {
+        TraceSpan span("effects");
+        tick();
+    }
+    TraceSpan span("output");
+    output().flushIfFull();
+}
+
+template<DerivedFromPhysicalItem T>
+optional<ErrorReason> World::checkTransfers(const vector<Transfer> &transfers, const string &kind)
+{
+    map<Character *, map<string, shared_ptr<const T>>> incoming;
+    map<Character *, set<string>> outgoing;
+    for (const auto &transfer: transfers) {
+        if (transfer.kind != kind) {
+            continue;
+        }
+        auto from = inventoryOf<T>(*transfer.from);
+        auto to = inventoryOf<T>(*transfer.to);
+        if (!from || !to) {
+            return ErrorReason::WrongRole;
+        }
+        if (!from->find(transfer.itemName)) {
+            return ErrorReason::UnknownItem;
+        }
+        if (!outgoing[transfer.from.get()].insert(transfer.itemName).second) {
+            return ErrorReason::InvalidValue;
+        }
+        auto &item = from->getItem(transfer.itemName);
+        if (!incoming[transfer.to.get()].emplace(transfer.itemName, item).second) {
+            return ErrorReason::NameTaken;
+        }
+    }
+    for (const auto &receiver: incoming) {
+        auto container = inventoryOf<T>(*receiver.first);
+        const auto &leaving = outgoing[receiver.first];
+        int slots = container->size() - static_cast<int>(leaving.size());
+        for (const auto &item: receiver.second) {
+            if (container->find(item.first) && !leaving.contains(item.first)) {
+                return ErrorReason::NameTaken;
+            }
+            slots++;
+        }
+        if (slots > container->getCapacity()) {
+            return ErrorReason::InventoryFull;
+        }
+    }
+    return nullopt;
+}
+
+template<DerivedFromPhysicalItem T>
+void World::moveItems(vector<Transfer> &transfers, const string &kind)
+{
+    vector<pair<Character *, typename Container<T>::Node>> moving;
+    for (auto &transfer: transfers) {
+        if (transfer.kind != kind) {
+            continue;
+        }
+        auto node = inventoryOf<T>(*transfer.from)->extractItem(transfer.itemName);
+        transfer.itemId = node.mapped()->getId();
+        moving.emplace_back(transfer.to.get(), std::move(node));
+    }
+    for (auto &move: moving) {
+        inventoryOf<T>(*move.first)->insertItem(std::move(move.second));
+    }
+}
+
+void World::transferItems(vector<Transfer> &transfers)
+{
+    for (const auto &transfer: transfers) {
+        if (transfer.from == transfer.to ||
+            (transfer.kind != "weapon" && transfer.kind != "potion" && transfer.kind != "spell")) {
+            errorCaught(ErrorReason::InvalidValue);
+            return;
+        }
+    }
+    auto error = checkTransfers<Weapon>(transfers, "weapon");
+    if (!error) {
+        error = checkTransfers<Potion>(transfers, "potion");
+    }
+    if (!error) {
+        error = checkTransfers<Spell>(transfers, "spell");
+    }
+    if (error) {
+        errorCaught(*error);
+        return;
+    }
+    moveItems<Weapon>(transfers, "weapon");
+    moveItems<Potion>(transfers, "potion");
+    moveItems<Spell>(transfers, "spell");
+    for (const auto &transfer: transfers) {
+        touch(transfer.from->getName());
+        touch(transfer.to->getName());
+        output() << transfer.from->getName() << " gives " << transfer.itemName << " to " << transfer.to->getName()
+             << ".\n";
+        if (events) {
+            events->itemTransferred(transfer.from->getId(), transfer.to->getId(), transfer.itemId);
+        }
+    }
+}
+
+bool World::readTransfers(span<const string_view> words, size_t &position, const shared_ptr<Character> &from,
+                          const shared_ptr<Character> &to, vector<Transfer> &transfers)
+{
+    if (position >= words.size()) {
+        return false;
+    }
+    int count = toInt(words[position++]);
+    if (count < 0 || position + 2 * static_cast<size_t>(count) > words.size()) {
+        return false;
+    }
+    for (int j = 0; j < count; ++j, position += 2) {
+        transfers.push_back({from, to, string(words[position]), string(words[position + 1])});
+    }
+    return true;
+}
+
+map<string, shared_ptr<Character>, less<>>::iterator World::findCharacter(string_view name)
+{
+    TraceSpan span("lookup");
+    return characters.find(name);
+}
+
+void World::showCharacters()
+{
+    auto &out = output();
+    unsigned workerCount = thread::hardware_concurrency();
+    if (characters.size() < parallelShowThreshold || workerCount < 2) {
+        for (const auto &character: characters) {
+            out << *character.second << ' ';
+        }
+        out << '\n';
+        return;
+    }
+    vector<const Character *> list;
+    list.reserve(characters.size());
+    for (const auto &character: characters) {
+        list.push_back(character.second.get());
+    }
+    vector<OutputBuffer> parts(workerCount);
+    vector<thread> workers;
+    size_t chunk = (list.size() + workerCount - 1) / workerCount;
+    for (unsigned t = 0; t < workerCount; t++) {
+        workers.emplace_back([&, t] {
+            size_t begin = min(list.size(), t * chunk);
+            size_t end = min(list.size(), begin + chunk);
+            parts[t].reserve((end - begin) * 24);
+            for (size_t i = begin; i < end; i++) {
+                parts[t] << *list[i] << ' ';
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    size_t total = 1;
+    for (auto &part: parts) {
+        total += part.str().size();
+    }
+    out.reserve(total);
+    for (auto &part: parts) {
+        out << part.str();
+    }
+    out << '\n';
+}
+
+vector<BattleSimulator::Combatant> World::simulationState()
+{
+    map<string_view, int> index;
+    for (const auto &character: characters) {
+        index.emplace(character.first, static_cast<int>(index.size()));
+    }
+    vector<BattleSimulator::Combatant> combatants;
+    for (const auto &character: characters) {
+        BattleSimulator::Combatant combatant{character.first, character.second->getHP(), {}, {}, {}};
+        if (auto arsenal = inventoryOf<Weapon>(*character.second)) {
+            for (const auto &weapon: arsenal->toShow()) {
+                combatant.weapons.push_back(weapon.second->getDamage());
+            }
+        }
+        if (auto medicalBag = inventoryOf<Potion>(*character.second)) {
+            for (const auto &potion: medicalBag->toShow()) {
+                combatant.potions.push_back(potion.second->getHealValue());
+            }
+        }
+        if (auto spellBook = inventoryOf<Spell>(*character.second)) {
+            for (const auto &spell: spellBook->toShow()) {
+                vector<int> targets;
+                for (const auto &target: spell.second->getTargets()) {
+                    auto it = index.find(target.first);
+                    if (target.second && it != index.end()) {
+                        targets.push_back(it->second);
+                    }
+                }
+                combatant.spells.push_back(std::move(targets));
+            }
+        }
+        combatants.push_back(std::move(combatant));
+    }
+    return combatants;
+}
+
+void World::resolveDeath(const shared_ptr<Character> &target)
+{
+    output() << target->getName() << " has died...\n";
+    if (events) {
+        events->death(target->getId());
+    }
+    statusEffects.cancelAll(*target);
+    rosterIndex.remove(*target);
+    touch(target->getName());
+    characters.erase(target->getName());
+}
+
+void World::tick()
+{
+    statusEffects.advance([&](Character &target, StatusEffects::Kind kind, int value) {
+        touch(target.getName());
+        if (kind == StatusEffects::Kind::Poison) {
+            output() << target.getName() << " takes " << value << " poison damage.\n";
+            if (events) {
+                events->damage(0, target.getId(), 0, value);
+            }
+            if (target.getHP() <= 0) {
+                auto it = characters.find(target.getName());
+                if (it != characters.end() && it->second.get() == &target) {
+                    auto victim = it->second;
+                    resolveDeath(victim);
+                }
+            }
+        } else {
+            output() << target.getName() << " regenerates " << value << " HP.\n";
+            if (events) {
+                events->heal(0, target.getId(), 0, value);
+            }
+        }
+    });
+}
+
+void World::resolveRound()
+{
+    TraceSpan roundSpan("round");
+    vector<shared_ptr<Character>> participants;
+    unordered_map<const Character *, size_t> participantIndex;
+    vector<int> frozenHP;
+    vector<Hit> hits;
+    auto indexOf = [&](const shared_ptr<Character> &character) {
+        auto [it, added] = participantIndex.emplace(character.get(), participants.size());
+        if (added) {
+            participants.push_back(character);
+            frozenHP.push_back(character->getHP());
+        }
+        return it->second;
+    };
+    {
+        TraceSpan span("dispatch");
+        for (const auto &action: roundActions) {
+            auto actorIt = findCharacter(action.actor);
+            auto targetIt = findCharacter(action.target);
+            if (actorIt == characters.end() || !actorIt->second || targetIt == characters.end() ||
+                !targetIt->second) {
+                errorCaught(ErrorReason::UnknownCharacter);
+                continue;
+            }
+            auto actor = actorIt->second;
+            auto target = targetIt->second;
+            if (action.command == "Attack") {
+                auto arsenal = inventoryOf<Weapon>(*actor);
+                if (!arsenal) {
+                    errorCaught(ErrorReason::WrongRole);
+                } else if (!arsenal->find(action.itemName)) {
+                    errorCaught(ErrorReason::UnknownItem);
+                } else {
+                    auto weapon = arsenal->getItem(action.itemName);
+                    hits.push_back({indexOf(target), -weapon->getDamage(), false});
+                    output() << actor->getName() << " attacks " << target->getName() << " with their "
+                             << action.itemName << "!\n";
+                    if (events) {
+                        events->damage(actor->getId(), target->getId(), weapon->getId(), weapon->getDamage());
+                    }
+                }
+            } else if (action.command == "Cast") {
+                auto spellBook = inventoryOf<Spell>(*actor);
+                if (!spellBook) {
+                    errorCaught(ErrorReason::WrongRole);
+                } else if (!spellBook->find(action.itemName)) {
+                    errorCaught(ErrorReason::UnknownItem);
+                } else if (!spellBook->getItem(action.itemName)->isTargetInList(*target)) {
+                    errorCaught(ErrorReason::TargetNotAllowed);
+                } else {
+                    auto spell = spellBook->getItem(action.itemName);
+                    hits.push_back({indexOf(target), 0, true});
+                    output() << actor->getName() << " casts " << action.itemName << " on " << target->getName()
+                             << "!\n";
+                    if (events) {
+                        events->damage(actor->getId(), target->getId(), spell->getId(), target->getHP());
+                        events->itemConsumed(actor->getId(), spell->getId());
+                    }
+                    spellBook->removeItem(action.itemName);
+                    touch(action.actor);
+                }
+            } else {
+                auto medicalBag = inventoryOf<Potion>(*actor);
+                if (!medicalBag) {
+                    errorCaught(ErrorReason::WrongRole);
+                } else if (!medicalBag->find(action.itemName)) {
+                    errorCaught(ErrorReason::UnknownItem);
+                } else {
+                    auto potion = medicalBag->getItem(action.itemName);
+                    hits.push_back({indexOf(target), potion->getHealValue(), false});
+                    output() << target->getName() << " drinks " << action.itemName << " from " << actor->getName()
+                             << ".\n";
+                    if (events) {
+                        events->heal(actor->getId(), target->getId(), potion->getId(), potion->getHealValue());
+                        events->itemConsumed(actor->getId(), potion->getId());
+                    }
+                    medicalBag->removeItem(action.itemName);
+                    touch(action.actor);
+                }
+            }
+        }
+        roundActions.clear();
+    }
+    //Every hit reads the frozen HP and writes into the second buffer
+    size_t count = participants.size();
+    vector<int> nextHP = frozenHP;
+    for (const auto &hit: hits) {
+        nextHP[hit.target] += hit.lethal ? -frozenHP[hit.target] : hit.amount;
+    }
+    vector<shared_ptr<Character>> dead;
+    for (size_t i = 0; i < count; i++) {
+        touch(participants[i]->getName());
+        int change = nextHP[i] - frozenHP[i];
+        if (change < 0) {
+            participants[i]->takeDamage(-change);
+        } else if (change > 0) {
+            participants[i]->heal(change);
+        }
+        if (nextHP[i] <= 0) {
+            dead.push_back(participants[i]);
+        }
+    }
+    //Everyone dies at once, reported in name order
+    sort(dead.begin(), dead.end(), [](const shared_ptr<Character> &a, const shared_ptr<Character> &b) {
+        return a->getName() < b->getName();
+    });
+    for (const auto &victim: dead) {
+        resolveDeath(victim);
+    }
+}
+
+size_t World::requiredWords(span<const string_view> words)
+{
+    auto word = [&](size_t i) { return i < words.size() ? words[i] : string_view(); };
+    if (words[0] == "Create") {
+        if (word(1) == "character") {
+            return 5;
+        }
+        if (word(1) == "item") {
+            return word(2) == "spell" ? 5 : word(2) == "potion" || word(2) == "weapon" ? 6 : 3;
+        }
+        return 2;
+    }
+    if (words[0] == "Show") {
+        if (word(1) == "hp") {
+            return 4;
+        }
+        return word(1) == "characters" ? 2 : 3;
+    }
+    if (words[0] == "Dialogue") {
+        return 3;
+    }
+    if (words[0] == "Drink" || words[0] == "Attack" || words[0] == "Cast" || words[0] == "Trade" ||
+        words[0] == "Simulate") {
+        return 4;
+    }
+    if (words[0] == "Give") {
+        return 5;
+    }
+    if (words[0] == "Effect") {
+        return 6;
+    }
+    if (words[0] == "Round") {
+        return 2;
+    }
+    return 1;
+}
+
+void World::dispatch(span<const string_view> words)
+{
+    if (words.size() < requiredWords(words)) {
+        errorCaught(ErrorReason::InvalidValue);
+        return;
+    }
+    //Case for an action inside a simultaneous round, done at the end of the round
+    if (roundOpen && (words[0] == "Attack" || words[0] == "Cast" || words[0] == "Drink")) {
+        roundActions.push_back({string(words[0]), string(words[1]), string(words[2]), string(words[3])});
+        return;
+    }
+    //Case creation of something
+    if (words[0] == "Create") {
+        //Creation of a character
+        if (words[1] == "character") {
+            string type(words[2]);
+            string name(words[3]);
+            int initHP = toInt(words[4]);
+            shared_ptr<Character> created;
+            if (type == "fighter") {
+                created = make_shared<Fighter>(name, initHP);
+            } else if (type == "wizard") {
+                created = make_shared<Wizard>(name, initHP);
+            } else if (type == "archer") {
+                created = make_shared<Archer>(name, initHP);
+            }
+            if (created) {
+                auto it = findCharacter(name);
+                if (it != characters.end() && it->second) {
+                    statusEffects.cancelAll(*it->second);
+                    rosterIndex.remove(*it->second);
+                }
+                created->setId(nextId++);
+                rosterIndex.add(*created);
+                characters[name] = created;
+                touch(name);
+                if (events) {
+                    int role = type == "fighter" ? 1 : type == "archer" ? 2 : 3;
+                    events->created(created->getId(), role, initHP, name);
+                }
+            }
+            return;
+            //Creation of an item
+        } else if (words[1] == "item") {
+            //Creation of a potion
+            if (words[2] == "potion") {
+                string ownerName(words[3]);
+                string potionName(words[4]);
+                int healValue = toInt(words[5]);
+                if (healValue <= 0) {
+                    errorCaught(ErrorReason::InvalidValue);
+                    return;
+                }
+                auto it = findCharacter(ownerName);
+                if (it != characters.end() && it->second) {
+                    auto character = it->second;
+                    if (auto potionUser = dynamic_cast<PotionUser *>(character.get())) {
+                        if (!potionUser->isFull()) {
+                            auto potion = itemRegistry.intern<Potion>(potionName, healValue, nextId);
+                            output() << ownerName << " just obtained a new potion called " << potionName << ".\n";
+                            characters[ownerName]->obtainItem(potion);
+                            touch(ownerName);
+                            if (events) {
+                                events->itemObtained(character->getId(), potion->getId(), Potion::kind,
+                                                     healValue, potionName);
+                            }
+                        } else {
+                            errorCaught(ErrorReason::InventoryFull);
+                        }
+                    } else {
+                        errorCaught(ErrorReason::WrongRole);
+                    }
+
+                } else {
+                    errorCaught(ErrorReason::UnknownCharacter);
+                }
+                //Creation of a weapon
+            } else if (words[2] == "weapon") {
+                string ownerName(words[3]);
+                string weaponName(words[4]);
+                int damage = toInt(words[5]);
+                if (damage <= 0) {
+                    errorCaught(ErrorReason::InvalidValue);
+                    return;
+                }
+                auto it = findCharacter(ownerName);
+                if (it != characters.end() && it->second) {
+                    auto character = it->second;
+                    if (auto weaponUser = dynamic_cast<WeaponUser *>(character.get())) {
+                        if (!weaponUser->isFull()) {
+                            auto weapon = itemRegistry.intern<Weapon>(weaponName, damage, nextId);
+                            output() << ownerName << " just obtained a new weapon called " << weaponName << ".\n";
+                            characters[ownerName]->obtainItem(weapon);
+                            touch(ownerName);
+                            if (events) {
+                                events->itemObtained(character->getId(), weapon->getId(), Weapon::kind, damage,
+                                                     weaponName);
+                            }
+                        } else {
+                            errorCaught(ErrorReason::InventoryFull);
+                        }
+                    } else {
+                        errorCaught(ErrorReason::WrongRole);
+                    }
+                } else {
+                    errorCaught(ErrorReason::UnknownCharacter);
+                }
+                //Creation of a spell
+            } else if (words[2] == "spell") {
+                string ownerName(words[3]);
+                string spellName(words[4]);
+                map<string, shared_ptr<Character>> targets;
+                auto it = findCharacter(ownerName);
+                if (it != characters.end() && it->second) {
+                    auto character = it->second;
+                    if (auto spellUser = dynamic_cast<SpellUser *>(character.get())) {
+                        if (!spellUser->isFull()) {
+                            bool flag = true;
+                            for (int j = 6; j < words.size(); ++j) {
+                                auto target = findCharacter(words[j]);
+                                if (target == characters.end()) {
+                                    errorCaught(ErrorReason::UnknownCharacter);
+                                    flag = false;
+                                    break;
+                                } else {
+                                    targets[target->second->getName()] = target->second;
+                                }
+                            }
+                            if (flag) {
+                                shared_ptr<Spell> spell = make_shared<Spell>(spellName, targets);
+                                spell->setId(nextId++);
+                                output() << ownerName << " just obtained a new spell called " << spellName << ".\n";
+                                characters[ownerName]->obtainItem(spell);
+                                touch(ownerName);
+                                if (events) {
+                                    events->itemObtained(character->getId(), spell->getId(), Spell::kind,
+                                                         spell->getTargetCount(), spellName);
+                                }
+                            }
+                        } else {
+                            errorCaught(ErrorReason::InventoryFull);
+                        }
+                    } else {
+                        errorCaught(ErrorReason::WrongRole);
+                    }
+                } else {
+                    errorCaught(ErrorReason::UnknownCharacter);
+                }
+            }
+        }
+        //Case of showing something
+    } else if (words[0] == "Show") {
+        //Showing characters
+        if (words[1] == "characters") {
+            showCharacters();
+            return;
+            //Showing the k characters with the lowest or highest HP
+        } else if (words[1] == "weakest" || words[1] == "strongest") {
+            int k = toInt(words[2]);
+            if (k < 0) {
+                errorCaught(ErrorReason::InvalidValue);
+                return;
+            }
+            auto print = [](Character &character) { output() << character << ' '; };
+            if (words[1] == "weakest") {
+                rosterIndex.weakest(k, print);
+            } else {
+                rosterIndex.strongest(k, print);
+            }
+            output() << '\n';
+            //Showing all characters of a role
+        } else if (words[1] == "role") {
+            string role(words[2]);
+            if (role != "fighter" && role != "archer" && role != "wizard") {
+                errorCaught(ErrorReason::InvalidValue);
+                return;
+            }
+            rosterIndex.withRole(role, [](Character &character) { output() << character << ' '; });
+            output() << '\n';
+            //Showing all characters with HP in a range
+        } else if (words[1] == "hp") {
+            int minHP = toInt(words[2]);
+            int maxHP = toInt(words[3]);
+            if (minHP > maxHP) {
+                errorCaught(ErrorReason::InvalidValue);
+                return;
+            }
+            rosterIndex.inRange(minHP, maxHP, [](Character &character) { output() << character << ' '; });
+            output() << '\n';
+        } else if (words[1] == "potions") {
+            string characterName(words[2]);
+            auto it = findCharacter(characterName);
+            if (it != characters.end() && it->second) {
+                auto character = it->second;
+                if (auto potionUser = dynamic_cast<PotionUser *>(character.get())) {
+                    potionUser->showPotions();
+                } else {
+                    errorCaught(ErrorReason::WrongRole);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+            //Showing weapons of a specific character
+        } else if (words[1] == "weapons") {
+            string characterName(words[2]);
+            auto it = findCharacter(characterName);
+            if (it != characters.end() && it->second) {
+                auto character = it->second;
+                if (auto weaponUser = dynamic_cast<WeaponUser *>(character.get())) {
+                    weaponUser->showWeapons();
+                } else {
+                    errorCaught(ErrorReason::WrongRole);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+            //Showing spells of a specific character
+        } else if (words[1] == "spells") {
+            string characterName(words[2]);
+            auto it = findCharacter(characterName);
+            if (it != characters.end() && it->second) {
+                auto character = it->second;
+                if (auto spellUser = dynamic_cast<SpellUser *>(character.get())) {
+                    spellUser->showSpells();
+                } else {
+                    errorCaught(ErrorReason::WrongRole);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+        }
+        //Case for initiating a dialogue
+    } else if (words[0] == "Dialogue") {
+        int numberOfWords = toInt(words[2]);
+        auto speech = words.subspan(3, min<size_t>(max(numberOfWords, 0), words.size() - 3));
+        //Case if narrator is speaking
+        if (words[1] == "Narrator") {
+            auto spoken = narrator.speak(speech);
+            if (events) {
+                events->dialogue(narrator.getId(), spoken);
+            }
+        } else {
+            auto it = findCharacter(words[1]);
+            if (it != characters.end() && it->second) {
+                auto spoken = it->second->speak(speech);
+                if (events) {
+                    events->dialogue(it->second->getId(), spoken);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+        }
+        //Case for drinking a potion
+    } else if (words[0] == "Drink") {
+        string supplierName(words[1]);
+        string drinkerName(words[2]);
+        string potionName(words[3]);
+        auto it = findCharacter(supplierName);
+        if (it != characters.end() && it->second) {
+            auto supplier = it->second;
+            it = findCharacter(drinkerName);
+            if (it != characters.end() && it->second) {
+                auto drinker = it->second;
+                auto sup = dynamic_cast<PotionUser *>(supplier.get());
+                auto dri = dynamic_cast<PotionUser *>(drinker.get());
+                sup->drink(*dri, potionName);
+                touch(supplierName);
+                touch(drinkerName);
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+        //Case for attacking
+    } else if (words[0] == "Attack") {
+        string attackerName(words[1]);
+        string targetName(words[2]);
+        string weaponName(words[3]);
+        auto it = findCharacter(attackerName);
+        if (it != characters.end() && it->second) {
+            auto attacker = it->second;
+            it = findCharacter(targetName);
+            if (it != characters.end() && it->second) {
+                auto target = it->second;
+                if (auto att = dynamic_cast<WeaponUser *>(attacker.get())) {
+                    att->attack(*target, weaponName);
+                    touch(targetName);
+                    if (target->getHP() <= 0) {
+                        resolveDeath(target);
+                    }
+                } else {
+                    errorCaught(ErrorReason::WrongRole);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+        //Case for casting a spell
+    } else if (words[0] == "Cast") {
+        string casterName(words[1]);
+        string targetName(words[2]);
+        string spellName(words[3]);
+        auto it = findCharacter(casterName);
+        if (it != characters.end() && it->second) {
+            auto attacker = it->second;
+            it = findCharacter(targetName);
+            if (it != characters.end() && it->second) {
+                auto target = it->second;
+                if (auto att = dynamic_cast<SpellUser *>(attacker.get())) {
+                    att->cast(*target, spellName);
+                    touch(casterName);
+                    touch(targetName);
+                    if (target->getHP() <= 0) {
+                        resolveDeath(target);
+                    }
+                } else {
+                    errorCaught(ErrorReason::WrongRole);
+                }
+            } else {
+                errorCaught(ErrorReason::UnknownCharacter);
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+        //Case for giving an item to another character
+    } else if (words[0] == "Give") {
+        auto from = findCharacter(words[1]);
+        auto to = findCharacter(words[2]);
+        if (from != characters.end() && from->second && to != characters.end() && to->second) {
+            vector<Transfer> transfers{{from->second, to->second, string(words[3]), string(words[4])}};
+            transferItems(transfers);
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+        //Case for exchanging items between two characters
+    } else if (words[0] == "Trade") {
+        auto first = findCharacter(words[1]);
+        auto second = findCharacter(words[2]);
+        if (first != characters.end() && first->second && second != characters.end() && second->second) {
+            vector<Transfer> transfers;
+            size_t position = 3;
+            if (readTransfers(words, position, first->second, second->second, transfers) &&
+                readTransfers(words, position, second->second, first->second, transfers) &&
+                position == words.size()) {
+                transferItems(transfers);
+            } else {
+                errorCaught(ErrorReason::InvalidValue);
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+        //Case for estimating battle outcomes
+    } else if (words[0] == "Simulate") {
+        int trials = toInt(words[1]);
+        int steps = toInt(words[2]);
+        int seed = toInt(words[3]);
+        if (trials <= 0 || steps < 0) {
+            errorCaught(ErrorReason::InvalidValue);
+            return;
+        }
+        BattleSimulator(simulationState()).run(trials, steps, static_cast<uint64_t>(seed), output());
+        //Case for starting or ending a simultaneous round
+    } else if (words[0] == "Round") {
+        if (words[1] == "begin" && !roundOpen) {
+            roundOpen = true;
+        } else if (words[1] == "end" && roundOpen) {
+            roundOpen = false;
+            resolveRound();
+        } else {
+            errorCaught(ErrorReason::InvalidValue);
+        }
+        //Case for putting a status effect on a character
+    } else if (words[0] == "Effect") {
+        string kind(words[1]);
+        string targetName(words[2]);
+        int value = toInt(words[3]);
+        int period = toInt(words[4]);
+        int times = toInt(words[5]);
+        if ((kind != "poison" && kind != "regeneration") || value <= 0 || period <= 0 || times <= 0) {
+            errorCaught(ErrorReason::InvalidValue);
+            return;
+        }
+        auto it = findCharacter(targetName);
+        if (it != characters.end() && it->second) {
+            if (kind == "poison") {
+                statusEffects.apply(*it->second, StatusEffects::Kind::Poison, value, period, times);
+                output() << targetName << " is poisoned.\n";
+            } else {
+                statusEffects.apply(*it->second, StatusEffects::Kind::Regeneration, value, period, times);
+                output() << targetName << " starts regenerating.\n";
+            }
+        } else {
+            errorCaught(ErrorReason::UnknownCharacter);
+        }
+    }
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+#include "BattleSimulator.h"
+#include "Characters.h"
+#include "RosterIndex.h"
+#include "StatusEffects.h"
+
+/**
+ * Immutable copy of everything the Show commands can display. Once built it is
+ * never modified, so any number of threads may read it without synchronization.
+ * Characters are spread over buckets by a hash of their name, about bucketSize per
+ * bucket, and a new snapshot shares every bucket without changed characters with the
+ * previous one. Taking a snapshot copies one pointer per bucket and, for every changed
+ * character, renders it and copies the few other entries of its bucket. The buckets
+ * are rebuilt from scratch once the roster grows past twice the size they were made for
+ * @param buckets - rendered state of every character, each bucket ordered by name
+ */
+class WorldSnapshot
+{
+public:
+    /**
+     * Rendered state of a single character
+     * @param character - the character as printed by Show characters
+     * @param weapons, potions, spells - lines printed by Show weapons/potions/spells,
+     * empty if the character can not hold such items
+     * @param role, HP - what the roster queries select the character by
+     */
+    struct Entry
+    {
+        std::string character;
+        std::string weapons;
+        std::string potions;
+        std::string spells;
+        std::string role;
+        int HP = 0;
+    };
+
+    static constexpr size_t bucketSize = 8;
+    using Bucket = std::map<std::string, Entry>;
+    using Buckets = std::vector<std::shared_ptr<const Bucket>>;
+
+private:
+    Buckets buckets;
+
+public:
+    explicit WorldSnapshot(Buckets buckets) : buckets(std::move(buckets)) {}
+
+    ~WorldSnapshot() = default;
+
+    /**
+     * @param characters Number of characters in the roster
+     * @return Number of buckets to spread them over, a power of two
+     */
+    static size_t bucketCountFor(size_t characters)
+    {
+        return std::bit_ceil(std::max<size_t>(1, characters / bucketSize));
+    }
+
+    /**
+     * @param name Name of a character
+     * @param bucketCount Number of buckets of the snapshot
+     * @return Index of the bucket the character is kept in
+     */
+    static size_t bucketOf(std::string_view name, size_t bucketCount)
+    {
+        return std::hash<std::string_view>()(name) & (bucketCount - 1);
+    }
+
+    //Getter
+    const Buckets &getBuckets() const
+    {
+        return buckets;
+    }
+
+    /**
+     * Answers a Show command the same way the world would at the moment of the snapshot
+     * @param command Line with the Show command
+     * @param os Stream to write the answer to
+     */
+    void show(const std::string &command, std::ostream &os) const;
+
+private:
+    /**
+     * @return All entries ordered by (HP, name), the order of the roster index
+     */
+    std::vector<std::pair<int, const Bucket::value_type *>> byHP() const;
+};
+
+/**
+ * The game world: all characters and the logic of executing commands on them
+ * @param characters - map of characters by name
+ * @param rosterIndex - index of the characters for roster queries
+ * @param narrator - character that speaks in the Narrator dialogues
+ * @param events - structured event stream, if enabled
+ * @param nextId - ID for the next created character or item, 0 is the narrator
+ * @param statusEffects - poison and regeneration effects, one tick passes with every command
+ * @param itemRegistry - weapons and potions shared by all their holders
+ * @param parallelShowThreshold - number of characters from which Show characters is formatted in parallel
+ * @param roundOpen - whether a simultaneous round is in progress
+ * @param roundActions - Attack, Cast and Drink commands queued in the current round
+ * @param lastSnapshot - the last snapshot taken, nullptr until the first one
+ * @param changed - names of the characters changed since the last snapshot, only tracked
+ * once a snapshot was taken
+ */
+class World
+{
+private:
+    std::map<std::string, std::shared_ptr<Character>, std::less<>> characters;
+    RosterIndex rosterIndex;
+    StatusEffects statusEffects;
+    ItemRegistry itemRegistry;
+    static constexpr size_t parallelShowThreshold = 1 << 16;
+    std::string narratorName = "Narrator";
+    Character narrator;
+    EventSink *events = nullptr;
+    int nextId = 1;
+
+    /**
+     * Attack, Cast or Drink command waiting for the end of the round
+     * @param command - Attack, Cast or Drink
+     * @param actor - attacker, caster or potion supplier
+     * @param target - character that is attacked, enchanted or drinks
+     * @param itemName - weapon, spell or potion used
+     */
+    struct RoundAction
+    {
+        std::string command;
+        std::string actor;
+        std::string target;
+        std::string itemName;
+    };
+
+    /**
+     * Checked round action: the damage or heal it deals to one of the targets of the round
+     * @param target - index of the target in the round
+     * @param amount - HP added to the target, negative for damage
+     * @param lethal - whether the action takes all HP the target had when the round ended
+     */
+    struct Hit
+    {
+        size_t target;
+        int amount;
+        bool lethal;
+    };
+
+    bool roundOpen = false;
+    std::vector<RoundAction> roundActions;
+    std::shared_ptr<const WorldSnapshot> lastSnapshot;
+    std::set<std::string> changed;
+public:
+    World() : narrator(narratorName, 0) {}
+
+    /**
+     * Runs no commands: a round still open when the world is destroyed is dropped
+     * with its queued actions, call finish first to resolve it
+     */
+    ~World() = default;
+
+    /**
+     * Enables the structured event stream
+     * @param sink Sink to write the events to, nullptr to disable
+     */
+    void setEventSink(EventSink *sink)
+    {
+        events = sink;
+    }
+
+    /**
+     * Renders the current state of all characters into an immutable snapshot.
+     * Only the characters changed since the previous snapshot are rendered again,
+     * unless the roster outgrew the buckets and all of them are rebuilt
+     * @return Snapshot that can be read from any thread
+     */
+    std::shared_ptr<const WorldSnapshot> takeSnapshot();
+
+    /**
+     * Executes a single command, writing its result to the standard output
+     * @param command Line of the input with the command
+     */
+    void execute(std::string_view command);
+
+    /**
+     * Executes a single command in process, appending its result to a string
+     * of the caller instead of the standard output
+     * @param command Line with the command
+     * @param out String the output of the command is appended to
+     */
+    void execute(std::string_view command, std::string &out);
+
+    /**
+     * Executes several commands in order, appending all their output to a string
+     * of the caller. Cheaper than calling execute for every command separately,
+     * as the output is redirected only once
+     * @param commands Lines with the commands
+     * @param out String the output of the commands is appended to
+     */
+    void executeBatch(std::span<const std::string_view> commands, std::string &out);
+
+    /**
+     * Ends the script: a round still open is resolved as if "Round end" was given,
+     * so its queued actions are not lost. Its result goes to the standard output
+     */
+    void finish();
+
+    /**
+     * Ends the script like finish(), appending the result of a round still open
+     * to a string of the caller instead of the standard output
+     * @param out String the output of the round is appended to
+     */
+    void finish(std::string &out);
+
+    /**
+     * Executes a single command that is already split into words
+     * @param words Words of the command
+     */
+    void execute(std::span<const std::string_view> words);
+
+private:
+    /**
+     * Renders the state of a character for a snapshot
+     * @param character The character
+     * @return Entry of the character in the snapshot
+     */
+    WorldSnapshot::Entry render(Character &character);
+
+    /**
+     * Marks a character as changed since the last snapshot
+     * @param name Name of the character
+     */
+    void touch(const std::string &name);
+
+    /**
+     * Executes a command, applies the status effects and flushes the output if needed
+     * @param words Words of the command
+     */
+    void run(std::span<const std::string_view> words);
+
+    /**
+     * Item to move from one character to another as part of a Give or Trade
+     * @param kind - weapon, potion or spell
+     * @param itemId - what was moved, filled in when the move is done
+     */
+    struct Transfer
+    {
+        std::shared_ptr<Character> from;
+        std::shared_ptr<Character> to;
+        std::string kind;
+        std::string itemName;
+        int itemId = 0;
+    };
+
+    /**
+     * Checks that all transfers of items of type T can be done together, taking into
+     * account the slots that the characters free by giving their own items away
+     * @param transfers All transfers of the operation
+     * @param kind Kind of the transfers to check
+     * @return Reason why the transfers are impossible, nothing if they are fine
+     */
+    template<DerivedFromPhysicalItem T>
+    std::optional<ErrorReason> checkTransfers(const std::vector<Transfer> &transfers, const std::string &kind);
+
+    /**
+     * Moves the items of all transfers of items of type T. All items are taken out
+     * before any is put back, so characters can swap items with the same name
+     * @param transfers All transfers of the operation, already checked
+     * @param kind Kind of the transfers to do
+     */
+    template<DerivedFromPhysicalItem T>
+    void moveItems(std::vector<Transfer> &transfers, const std::string &kind);
+
+    /**
+     * Does all transfers, or none of them if any is impossible
+     * @param transfers Transfers to do
+     */
+    void transferItems(std::vector<Transfer> &transfers);
+
+    /**
+     * Reads a list "<count> <kind> <item> ..." of items given by one character to another
+     * @param words Words of the command
+     * @param position Position of the count, moved past the list
+     * @param from Character that gives the items
+     * @param to Character that gets the items
+     * @param transfers Where to add the transfers
+     * @return false if the list is malformed
+     */
+    bool readTransfers(std::span<const std::string_view> words, size_t &position,
+                       const std::shared_ptr<Character> &from, const std::shared_ptr<Character> &to,
+                       std::vector<Transfer> &transfers);
+
+    /**
+     * Finds a character by name
+     * @param name Name of the character
+     * @return Iterator to the character in the map, end if there is none
+     */
+    std::map<std::string, std::shared_ptr<Character>, std::less<>>::iterator findCharacter(std::string_view name);
+
+    /**
+     * Prints all characters in name order. Large rosters are formatted in chunks
+     * by several threads and the chunks are concatenated in order
+     */
+    void showCharacters();
+
+    /**
+     * Copies the characters and their inventories for the battle simulator
+     * @return Characters in name order
+     */
+    std::vector<BattleSimulator::Combatant> simulationState();
+
+    /**
+     * Prints the death of a character and removes it from the world
+     * @param target Character with no HP left
+     */
+    void resolveDeath(const std::shared_ptr<Character> &target);
+
+    /**
+     * Applies the status effects that are due after a command
+     */
+    void tick();
+
+    /**
+     * Ends a simultaneous round. The queued actions are checked and printed in order,
+     * then every action reads the HP that the characters had when the round ended and
+     * writes its damage or heal into a second HP buffer, so no action sees the effect of
+     * another one. At the end the new HP is applied and all characters left without HP
+     * die together
+     */
+    void resolveRound();
+
+    /**
+     * Gives the number of words a command needs, so that dispatch can reject short
+     * commands instead of reading past their end. Commands with optional words,
+     * like Trade and Create item spell, check the rest themselves
+     * @param words Words of the command, at least one
+     * @return Minimal number of words of the command
+     */
+    static size_t requiredWords(std::span<const std::string_view> words);
+
+    /**
+     * Executes a command split into words
+     * @param words Words of the command
+     */
+    void dispatch(std::span<const std::string_view> words);
+};
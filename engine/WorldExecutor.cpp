@@ -0,0 +1,91 @@
+#include "WorldExecutor.h"
+
+using namespace std;
+
+WorldExecutor::WorldExecutor(World &w, FILE *out) : world(w), outputFile(out)
+{
+    slots[0] = world.takeSnapshot();
+    writer = thread([this] { run(); });
+}
+
+void WorldExecutor::submit(string command)
+{
+    queue.push(std::move(command));
+    wake();
+}
+
+shared_ptr<const WorldSnapshot> WorldExecutor::snapshot()
+{
+    if (!snapshotRequested.exchange(true, memory_order_acq_rel)) {
+        wake();
+    }
+    while (true) {
+        int slot = current.load();
+        readers[slot].fetch_add(1);
+        if (current.load() == slot) {
+            shared_ptr<const WorldSnapshot> result = slots[slot];
+            readers[slot].fetch_sub(1);
+            return result;
+        }
+        readers[slot].fetch_sub(1);
+    }
+}
+
+void WorldExecutor::stop()
+{
+    if (!writer.joinable()) {
+        return;
+    }
+    stopping.store(true, memory_order_release);
+    wake();
+    writer.join();
+}
+
+void WorldExecutor::publish(shared_ptr<const WorldSnapshot> snapshot)
+{
+    int next = 1 - current.load();
+    while (readers[next].load() != 0) {
+        this_thread::yield();
+    }
+    slots[next] = std::move(snapshot);
+    current.store(next);
+}
+
+void WorldExecutor::wake()
+{
+    signal.fetch_add(1, memory_order_release);
+    signal.notify_one();
+}
+
+void WorldExecutor::run()
+{
+    OutputBuffer out(outputFile);
+    OutputBuffer::active = &out;
+    bool dirty = false;
+    string command;
+    while (true) {
+        auto seen = signal.load(memory_order_acquire);
+        bool stop = stopping.load(memory_order_acquire);
+        int executed = 0;
+        while (executed < maxBatch && queue.pop(command)) {
+            world.execute(command);
+            executed++;
+        }
+        dirty = dirty || executed > 0;
+        if (dirty && snapshotRequested.load(memory_order_acquire)) {
+            snapshotRequested.store(false, memory_order_release);
+            publish(world.takeSnapshot());
+            dirty = false;
+        }
+        if (executed == maxBatch) {
+            continue;
+        }
+        if (stop) {
+            break;
+        }
+        if (executed == 0) {
+            signal.wait(seen, memory_order_acquire);
+        }
+    }
+    OutputBuffer::active = nullptr;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "World.h"
+
+/**
+ * Lock-free multi-producer single-consumer queue of commands
+ * (intrusive linked list with a stub node, push is a single atomic exchange)
+ * @param head - last pushed node, shared by the producers
+ * @param tail - last consumed node, owned by the consumer
+ */
+class CommandQueue
+{
+private:
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        std::string command;
+    };
+
+    std::atomic<Node *> head;
+    Node *tail;
+    Node stub;
+public:
+    CommandQueue() : head(&stub), tail(&stub) {}
+
+    ~CommandQueue()
+    {
+        Node *node = tail;
+        while (node) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            if (node != &stub) {
+                delete node;
+            }
+            node = next;
+        }
+    }
+
+    CommandQueue(const CommandQueue &) = delete;
+
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    /**
+     * Adds a command to the end of the queue. Safe to call from any thread
+     * @param command Command to add
+     */
+    void push(std::string command)
+    {
+        Node *node = new Node;
+        node->command = std::move(command);
+        Node *prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Takes a command from the front of the queue. Must only be called by the consumer
+     * @param command Where to put the command
+     * @return false if the queue is empty
+     */
+    bool pop(std::string &command)
+    {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        command = std::move(next->command);
+        if (tail != &stub) {
+            delete tail;
+        }
+        tail = next;
+        return true;
+    }
+};
+
+/**
+ * Runs commands from many client threads on one world using a single writer thread.
+ * Readers never touch the world itself: they get the last published snapshot,
+ * which the writer renews between batches of commands whenever a reader asked for it
+ * and the world has changed since. Renewing it renders the changed characters again
+and copies their buckets, see WorldSnapshot.
+ * Snapshots are published RCU-style through two slots: readers pin the current slot
+ * with a counter, and the writer only overwrites the other slot once its readers are gone.
+ * Old snapshots are freed when their last reader drops them
+ * @param world - the world owned by the writer thread while the executor runs
+ * @param outputFile - where the output of the commands goes
+ * @param queue - commands submitted by the clients
+ * @param signal - counter bumped on every submit, the writer sleeps on it when idle
+ * @param slots - the published snapshot and the previous one, written only by the writer
+ * @param current - index of the slot with the published snapshot
+ * @param readers - number of readers copying each slot
+ * @param snapshotRequested - set by readers, cleared by the writer when it publishes
+ * @param maxBatch - number of commands executed between two snapshot checks
+ */
+class WorldExecutor
+{
+private:
+    World &world;
+    FILE *outputFile;
+    CommandQueue queue;
+    std::atomic<unsigned long long> signal{0};
+    std::atomic<bool> stopping{false};
+    std::shared_ptr<const WorldSnapshot> slots[2];
+    std::atomic<int> current{0};
+    std::atomic<int> readers[2] = {0, 0};
+    std::atomic<bool> snapshotRequested{false};
+    const int maxBatch = 1024;
+    std::thread writer;
+public:
+    /**
+     * Starts the writer thread
+     * @param w World to run the commands on
+     * @param out File the output of the commands is written to
+     */
+    explicit WorldExecutor(World &w, FILE *out = stdout);
+
+    ~WorldExecutor()
+    {
+        stop();
+    }
+
+    WorldExecutor(const WorldExecutor &) = delete;
+
+    WorldExecutor &operator=(const WorldExecutor &) = delete;
+
+    /**
+     * Queues a command for execution. Safe to call from any thread
+     * @param command Command to execute
+     */
+    void submit(std::string command);
+
+    /**
+     * Gets the most recent snapshot of the world without waiting for the writer.
+     * Safe to call from any thread
+     * @return Snapshot of the world
+     */
+    std::shared_ptr<const WorldSnapshot> snapshot();
+
+    /**
+     * Executes all submitted commands and stops the writer thread
+     */
+    void stop();
+
+private:
+    /**
+     * Makes a new snapshot visible to the readers. Called only by the writer thread
+     * @param snapshot Snapshot to publish
+     */
+    void publish(std::shared_ptr<const WorldSnapshot> snapshot);
+
+    void wake();
+
+    /**
+     * Main loop of the writer thread
+     */
+    void run();
+};
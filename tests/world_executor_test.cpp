@@ -0,0 +1,126 @@
+#include "engine/WorldExecutor.h"
+
+using namespace std;
+
+const int clientCount = 4;
+const int readerCount = 4;
+const int fightersPerClient = 50;
+const int attacksPerFighter = 40;
+const int startHP = 1000;
+const int damage = 7;
+
+/**
+ * @return Name of a fighter of a client
+ */
+string fighterName(int client, int fighter)
+{
+    return "F" + to_string(client) + "_" + to_string(fighter);
+}
+
+/**
+ * Reads the HP of every character from the answer to Show characters
+ * @param shown Answer of the snapshot
+ * @return HP by name
+ */
+map<string, int> parseCharacters(const string &shown)
+{
+    map<string, int> result;
+    istringstream iss(shown);
+    string word;
+    while (iss >> word) {
+        auto last = word.rfind(':');
+        result[word.substr(0, word.find(':'))] = stoi(word.substr(last + 1));
+    }
+    return result;
+}
+
+/**
+ * Stress test of WorldExecutor with several client threads submitting commands and
+ * several readers polling snapshots at the same time.
+ * Every client creates its own fighters and then attacks them, so the final HP of
+ * every fighter does not depend on how the clients interleave. Readers check that
+ * every snapshot they get is consistent: a fighter is either absent or has one of the
+ * HP values it can pass through, and its HP never grows between two snapshots
+ */
+int main()
+{
+    World world;
+    FILE *sink = tmpfile();
+    if (!sink) {
+        cerr << "Can not create a temporary file" << endl;
+        return 1;
+    }
+    atomic<bool> failed{false};
+    atomic<int> clientsLeft{clientCount};
+    atomic<long long> snapshotsRead{0};
+    {
+        WorldExecutor executor(world, sink);
+        vector<thread> threads;
+        for (int c = 0; c < clientCount; c++) {
+            threads.emplace_back([&, c] {
+                for (int f = 0; f < fightersPerClient; f++) {
+                    string name = fighterName(c, f);
+                    executor.submit("Create character fighter " + name + " " + to_string(startHP));
+                    executor.submit("Create item weapon " + name + " Axe " + to_string(damage));
+                }
+                for (int a = 0; a < attacksPerFighter; a++) {
+                    for (int f = 0; f < fightersPerClient; f++) {
+                        executor.submit("Attack " + fighterName(c, (f + 1) % fightersPerClient) + " " +
+                                        fighterName(c, f) + " Axe");
+                    }
+                }
+                clientsLeft.fetch_sub(1);
+            });
+        }
+        for (int r = 0; r < readerCount; r++) {
+            threads.emplace_back([&] {
+                map<string, int> previous;
+                while (clientsLeft.load() > 0 && !failed.load()) {
+                    ostringstream shown;
+                    executor.snapshot()->show("Show characters", shown);
+                    auto current = parseCharacters(shown.str());
+                    for (const auto &character: current) {
+                        int lost = startHP - character.second;
+                        auto it = previous.find(character.first);
+                        if (lost < 0 || lost % damage != 0 || lost > damage * attacksPerFighter ||
+                            (it != previous.end() && it->second < character.second)) {
+                            cerr << "Inconsistent snapshot: " << character.first << " has " << character.second
+                                 << " HP" << endl;
+                            failed.store(true);
+                        }
+                    }
+                    previous = std::move(current);
+                    snapshotsRead.fetch_add(1);
+                }
+            });
+        }
+        for (auto &t: threads) {
+            t.join();
+        }
+        executor.stop();
+    }
+    fclose(sink);
+
+    //The world is owned by this thread again, so its final state can be checked directly
+    ostringstream shown;
+    world.takeSnapshot()->show("Show characters", shown);
+    auto final = parseCharacters(shown.str());
+    if (final.size() != clientCount * fightersPerClient) {
+        cerr << "Expected " << clientCount * fightersPerClient << " characters, got " << final.size() << endl;
+        failed.store(true);
+    }
+    for (const auto &character: final) {
+        if (character.second != startHP - damage * attacksPerFighter) {
+            cerr << character.first << " ended with " << character.second << " HP" << endl;
+            failed.store(true);
+        }
+    }
+    ostringstream weakest;
+    world.takeSnapshot()->show("Show weakest 1", weakest);
+    if (weakest.str() != fighterName(0, 0) + ":fighter:" + to_string(startHP - damage * attacksPerFighter) + " \n") {
+        cerr << "Unexpected answer to Show weakest 1: " << weakest.str();
+        failed.store(true);
+    }
+    cout << snapshotsRead.load() << " snapshots read" << endl;
+    return failed.load() ? 1 : 0;
+}